@@ -1,49 +1,264 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fast_input.h"
 using namespace std;
 
 const int MOD = 1000003;
 
-// Function to multiply two 2x2 matrices modulo MOD
-void multiplyMatrix(long long A[2][2], long long B[2][2]) {
-    long long a = (A[0][0] * B[0][0] + A[0][1] * B[1][0]) % MOD;
-    long long b = (A[0][0] * B[0][1] + A[0][1] * B[1][1]) % MOD;
-    long long c = (A[1][0] * B[0][0] + A[1][1] * B[1][0]) % MOD;
-    long long d = (A[1][0] * B[0][1] + A[1][1] * B[1][1]) % MOD;
-
-    A[0][0] = a;
-    A[0][1] = b;
-    A[1][0] = c;
-    A[1][1] = d;
-}
+// Barrett reduction for a modulus known at compile time. Any 64-bit value is
+// reduced with one 128-bit multiply and at most one correction step.
+template <uint32_t Mod>
+struct BarrettReducer {
+    static_assert(Mod > 1 && Mod < (1u << 31), "modulus must fit in 31 bits");
 
-// Function to raise a 2x2 matrix to the power `p` using binary exponentiation
-void matrixExponentiation(long long mat[2][2], long long p) {
-    if (p <= 1)
-        return;
+    static constexpr uint64_t kInverse = ~0ULL / Mod;
+    // Products of two reduced values that can be summed before reducing
+    static constexpr uint64_t kLazyTerms = ~0ULL / (uint64_t(Mod - 1) * (Mod - 1));
 
-    long long base[2][2] = {{1, 1}, {1, 0}};
+    static uint32_t reduce(uint64_t x) {
+        uint64_t q = static_cast<uint64_t>((static_cast<unsigned __int128>(x) * kInverse) >> 64);
+        uint64_t r = x - q * Mod;
+        return static_cast<uint32_t>(r >= Mod ? r - Mod : r);
+    }
+};
 
-    matrixExponentiation(mat, p / 2);
-    multiplyMatrix(mat, mat);
+// Engine for order-K linear recurrences a(n) = c1*a(n-1) + ... + cK*a(n-K)
+// modulo a compile-time Mod. Small orders use iterative powering of the K x K
+// companion matrix; larger orders use Kitamasa's method, i.e. computing
+// x^n modulo the characteristic polynomial in O(K^2 log n).
+template <int K, uint32_t Mod>
+class RecurrenceMatrix {
+public:
+    using Vector = array<uint32_t, K>;
+    using Matrix = array<Vector, K>;
+    using Reducer = BarrettReducer<Mod>;
 
-    if (p % 2 != 0)
-        multiplyMatrix(mat, base);
-}
+    static constexpr int kKitamasaThreshold = 4;
+
+    // coefficients[i] multiplies a(n-1-i)
+    explicit RecurrenceMatrix(const Vector& coefficients) : coefficients(coefficients) {}
+
+    // Returns a(n) given the initial terms a(0)..a(K-1)
+    uint32_t nthTerm(unsigned long long n, const Vector& initial) const {
+        if (n < static_cast<unsigned long long>(K)) return initial[n];
+        if constexpr (K < kKitamasaThreshold) {
+            return matrixTerm(n, initial);
+        } else {
+            return kitamasaTerm(n, initial);
+        }
+    }
+
+private:
+    Vector coefficients;
+
+    // Sum of products of reduced values, reduced once per dot product unless
+    // the modulus is large enough that the accumulator would overflow
+    template <typename Left, typename Right>
+    static uint32_t dotProduct(int length, Left left, Right right) {
+        uint64_t sum = 0;
+        uint64_t pending = 0;
+        for (int i = 0; i < length; ++i) {
+            if (pending == Reducer::kLazyTerms) {
+                sum = Reducer::reduce(sum);
+                pending = 1;
+            }
+            sum += uint64_t(left(i)) * right(i);
+            ++pending;
+        }
+        return Reducer::reduce(sum);
+    }
+
+    static Matrix multiply(const Matrix& A, const Matrix& B) {
+        Matrix C;
+        for (int i = 0; i < K; ++i) {
+            for (int j = 0; j < K; ++j) {
+                C[i][j] = dotProduct(K, [&](int t) { return A[i][t]; },
+                                     [&](int t) { return B[t][j]; });
+            }
+        }
+        return C;
+    }
+
+    uint32_t matrixTerm(unsigned long long n, const Vector& initial) const {
+        // Companion matrix maps (a(k+K-1), ..., a(k)) to (a(k+K), ..., a(k+1))
+        Matrix base{};
+        base[0] = coefficients;
+        for (int i = 1; i < K; ++i) base[i][i - 1] = 1;
+
+        Matrix result{};
+        for (int i = 0; i < K; ++i) result[i][i] = 1;
+
+        for (unsigned long long p = n; p > 0; p >>= 1) {
+            if (p & 1) result = multiply(result, base);
+            if (p > 1) base = multiply(base, base);
+        }
+
+        // The last row of M^n applied to the initial state vector gives a(n)
+        return dotProduct(K, [&](int t) { return result[K - 1][t]; },
+                          [&](int t) { return initial[K - 1 - t]; });
+    }
+
+    // Product of two polynomials of degree < K reduced modulo
+    // x^K - c1*x^(K-1) - ... - cK
+    Vector multiplyModCharacteristic(const Vector& a, const Vector& b) const {
+        array<uint64_t, 2 * K - 1> product;
+        for (int d = 0; d < 2 * K - 1; ++d) {
+            int low = d < K ? 0 : d - K + 1;
+            int high = d < K ? d : K - 1;
+            product[d] = dotProduct(high - low + 1, [&](int t) { return a[low + t]; },
+                                    [&](int t) { return b[d - low - t]; });
+        }
+
+        // Each slot receives at most K more products before it is read
+        constexpr bool lazy = Reducer::kLazyTerms > static_cast<uint64_t>(K);
+        for (int d = 2 * K - 2; d >= K; --d) {
+            uint64_t top = Reducer::reduce(product[d]);
+            for (int j = 0; j < K; ++j) {
+                product[d - 1 - j] += top * coefficients[j];
+                if (!lazy) product[d - 1 - j] = Reducer::reduce(product[d - 1 - j]);
+            }
+        }
+
+        Vector result;
+        for (int i = 0; i < K; ++i) result[i] = Reducer::reduce(product[i]);
+        return result;
+    }
+
+    uint32_t kitamasaTerm(unsigned long long n, const Vector& initial) const {
+        Vector base{};
+        base[1] = 1;  // the polynomial x
+        Vector result{};
+        result[0] = 1;
+
+        for (unsigned long long p = n; p > 0; p >>= 1) {
+            if (p & 1) result = multiplyModCharacteristic(result, base);
+            if (p > 1) base = multiplyModCharacteristic(base, base);
+        }
+
+        // x^n = sum r_i x^i  implies  a(n) = sum r_i a(i)
+        return dotProduct(K, [&](int t) { return result[t]; },
+                          [&](int t) { return initial[t]; });
+    }
+};
+
+using FibonacciRecurrence = RecurrenceMatrix<2, MOD>;
 
 // Function to calculate the nth Fibonacci number modulo MOD
 int calculateFibonacci(long long n) {
     if (n == 1) return 0; // First Fibonacci number is 0
     if (n == 2) return 1; // Second Fibonacci number is 1
 
-    long long fibMatrix[2][2] = {{1, 1}, {1, 0}};
-    matrixExponentiation(fibMatrix, n - 2); // Compute the (n-2)th power
+    static const FibonacciRecurrence recurrence({1, 1});
+    return recurrence.nthTerm(n - 1, {0, 1});
+}
+
+// Precomputed Fibonacci numbers modulo MOD over one full Pisano period.
+// F(n) mod MOD repeats with the period of the pair (F(k), F(k+1)), so any
+// query reduces to a single table lookup after one modulo by the period.
+class FibonacciTable {
+public:
+    FibonacciTable() {
+        // For the prime MOD the period divides 2 * (MOD + 1), which bounds the scan
+        values.reserve(2 * (MOD + 1));
+        uint32_t current = 0, next = 1;
+        do {
+            values.push_back(current);
+            uint32_t sum = current + next;
+            current = next;
+            next = sum >= MOD ? sum - MOD : sum;
+        } while (current != 0 || next != 1);
+        period = values.size();
+    }
+
+    // Same indexing as calculateFibonacci: the first Fibonacci number is 0
+    int lookup(long long n) const {
+        return values[static_cast<uint64_t>(n - 1) % period];
+    }
+
+    uint64_t getPeriod() const {
+        return period;
+    }
 
-    return fibMatrix[0][0]; // Return the top-left element as F(n)
+private:
+    vector<uint32_t> values;
+    uint64_t period;
+};
+
+// Answer every `n` on stdin, one result per line, from the precomputed table
+int runBatch() {
+    ios::sync_with_stdio(false);
+
+    FibonacciTable table;
+    FastInput input;
+    string output;
+    long long n;
+    while (input.Read(n)) {
+        output += to_string(table.lookup(n));
+        output += '\n';
+        if (output.size() >= (1 << 16)) {
+            cout << output;
+            output.clear();
+        }
+    }
+    cout << output;
+    return 0;
 }
 
-int main() {
+// Compare throughput of the per-query matrix path against the table lookup
+int runBenchmark(long long queryCount) {
+    mt19937_64 generator(12345);
+    uniform_int_distribution<long long> distribution(1, 1000000000000000000LL);
+    vector<long long> queries(queryCount);
+    for (long long& query : queries) {
+        query = distribution(generator);
+    }
+
+    auto start = chrono::steady_clock::now();
+    FibonacciTable table;
+    auto built = chrono::steady_clock::now();
+
+    unsigned long long tableChecksum = 0;
+    for (long long query : queries) {
+        tableChecksum += table.lookup(query);
+    }
+    auto tableDone = chrono::steady_clock::now();
+
+    unsigned long long matrixChecksum = 0;
+    for (long long query : queries) {
+        matrixChecksum += calculateFibonacci(query);
+    }
+    auto matrixDone = chrono::steady_clock::now();
+
+    auto seconds = [](chrono::steady_clock::duration d) {
+        return chrono::duration<double>(d).count();
+    };
+    double tableSeconds = seconds(tableDone - built);
+    double matrixSeconds = seconds(matrixDone - tableDone);
+
+    cout << "queries:        " << queryCount << endl;
+    cout << "pisano period:  " << table.getPeriod() << endl;
+    cout << "table build:    " << seconds(built - start) << " s" << endl;
+    cout << "matrix path:    " << queryCount / matrixSeconds << " queries/s" << endl;
+    cout << "table path:     " << queryCount / tableSeconds << " queries/s" << endl;
+    cout << "checksums:      " << (tableChecksum == matrixChecksum ? "match" : "MISMATCH") << endl;
+    return tableChecksum == matrixChecksum ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--batch") return runBatch();
+    if (mode == "--bench") return runBenchmark(argc > 2 ? atoll(argv[2]) : 1000000);
+
+    FastInput input;
     long long n;
-    cin >> n;
+    input.Read(n);
     cout << calculateFibonacci(n) << endl;
     return 0;
 }
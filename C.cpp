@@ -1,7 +1,19 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "fast_input.h"
+
 const int MAX_NODES = 53;
 int graph[MAX_NODES][MAX_NODES];
 
@@ -17,53 +29,296 @@ void performDFS(int node, std::vector<bool>& visited, std::vector<int>& currentC
     }
 }
 
-// Find the largest group of fully connected nodes using bitmasking
-std::vector<int> findMaxFullyConnectedGroup(int n) {
-    std::vector<bool> validSubsets(1 << n, false); // Valid subsets of nodes
-    std::vector<int> adjacencyMask(n, 0);         // Adjacency masks for nodes
-    std::vector<int> largestGroup;                // Resultant largest group
+static_assert(MAX_NODES <= 64, "adjacency masks are single 64-bit words");
 
-    // Build adjacency masks for each node
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            if (graph[i][j] == 1) {
-                adjacencyMask[i] |= (1 << j);
+// Branch-and-bound maximum clique search over 64-bit adjacency masks.
+// Candidates are greedily partitioned into independent color classes; the
+// number of classes bounds the clique that can still be added, so branches
+// that cannot beat the incumbent are cut without being expanded.
+//
+// With more than one thread the top levels of the search tree become tasks
+// on a work-stealing pool. The incumbent size is a shared atomic, so a better
+// clique found by any worker prunes every other worker's branches. The
+// workers are started by the first parallel search and stay parked between
+// searches, so the many small decision searches of smallestMaximumClique
+// do not each pay for creating and joining threads.
+class MaxCliqueSolver {
+public:
+    explicit MaxCliqueSolver(int n, int threadCount = 1)
+        : adjacencyMask(n, 0), allNodes(0), threadCount(std::max(threadCount, 1)),
+          queues(this->threadCount) {
+        // Edges are taken from the upper triangle, as in the subset DP
+        for (int i = 0; i < n; ++i) {
+            allNodes |= bit(i);
+            for (int j = i + 1; j < n; ++j) {
+                if (graph[i][j] == 1) {
+                    adjacencyMask[i] |= bit(j);
+                    adjacencyMask[j] |= bit(i);
+                }
             }
         }
     }
 
-    // Determine valid subsets using dynamic programming
-    for (int subset = 1; subset < (1 << n); ++subset) {
-        if ((subset & (subset - 1)) == 0) { // Single-node subsets are valid
-            validSubsets[subset] = true;
+    MaxCliqueSolver(const MaxCliqueSolver&) = delete;
+    MaxCliqueSolver& operator=(const MaxCliqueSolver&) = delete;
+
+    ~MaxCliqueSolver() {
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            stopping = true;
+        }
+        searchStarted.notify_all();
+        for (std::thread& thread : workers) {
+            thread.join();
+        }
+    }
+
+    // Size of the largest clique among `candidates`, stopping early once
+    // `stopSize` is reached
+    int largestClique(uint64_t candidates, int stopSize) {
+        bestSize.store(0, std::memory_order_relaxed);
+        targetSize = stopSize;
+        if (threadCount == 1 || __builtin_popcountll(candidates) < PARALLEL_MIN_CANDIDATES) {
+            expand(candidates, 0);
         } else {
-            int lowestBitNode = __builtin_ctz(subset); // Rightmost set bit
-            int subsetWithoutNode = subset ^ (1 << lowestBitNode);
+            runParallel(candidates);
+        }
+        return bestSize.load(std::memory_order_relaxed);
+    }
+
+    // The maximum clique with the numerically smallest node mask. Nodes are
+    // decided from the highest index down: a node is dropped whenever a
+    // clique of maximum size still exists without it. This keeps the answer
+    // independent of the order in which parallel workers find cliques.
+    uint64_t smallestMaximumClique() {
+        int maxSize = largestClique(allNodes, __builtin_popcountll(allNodes));
+        uint64_t required = 0;
+        uint64_t allowed = allNodes;
 
-            if (validSubsets[subsetWithoutNode] &&
-                (subsetWithoutNode & adjacencyMask[lowestBitNode]) == subsetWithoutNode) {
-                validSubsets[subset] = true;
+        for (int node = static_cast<int>(adjacencyMask.size()) - 1; node >= 0; --node) {
+            if (!(allowed & bit(node))) continue;
+
+            uint64_t withoutNode = allowed & ~bit(node);
+            uint64_t candidates = withoutNode & commonNeighbors(required);
+            int needed = maxSize - __builtin_popcountll(required);
+            if (largestClique(candidates, needed) >= needed) {
+                allowed = withoutNode;
+            } else {
+                required |= bit(node);
+                allowed &= adjacencyMask[node] | bit(node);
             }
         }
+        return required;
     }
 
-    // Identify the largest valid subset
-    for (int subset = 1; subset < (1 << n); ++subset) {
-        if (validSubsets[subset] && __builtin_popcount(subset) > largestGroup.size()) {
-            largestGroup.clear();
-            for (int i = 0; i < n; ++i) {
-                if (subset & (1 << i)) {
-                    largestGroup.push_back(i);
-                }
+private:
+    // Tasks above this depth are split into child tasks instead of recursing
+    static const int SPLIT_DEPTH = 2;
+    // Searches over fewer candidates finish faster than a pool wakeup
+    static const int PARALLEL_MIN_CANDIDATES = 24;
+
+    struct Task {
+        uint64_t candidates;
+        int depth;
+        int bound;  // depth plus the color bound of the branch
+    };
+
+    // Per-worker deque: the owner pushes and pops at the back, thieves take
+    // the oldest (largest) subproblems from the front
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<uint64_t> adjacencyMask;
+    uint64_t allNodes;
+    int threadCount;
+    std::atomic<int> bestSize{0};
+    int targetSize = 0;
+    std::vector<WorkerQueue> queues;
+    std::atomic<int> pendingTasks{0};
+
+    // Persistent pool: workers 1..threadCount-1 wait for the search
+    // generation to change, drain the queues, and report back
+    std::vector<std::thread> workers;
+    std::mutex poolLock;
+    std::condition_variable searchStarted;
+    std::condition_variable searchFinished;
+    uint64_t generation = 0;
+    int runningWorkers = 0;
+    bool stopping = false;
+
+    static uint64_t bit(int node) {
+        return uint64_t(1) << node;
+    }
+
+    uint64_t commonNeighbors(uint64_t nodes) const {
+        uint64_t common = allNodes;
+        for (; nodes; nodes &= nodes - 1) {
+            common &= adjacencyMask[__builtin_ctzll(nodes)];
+        }
+        return common;
+    }
+
+    void raiseBest(int size) {
+        int current = bestSize.load(std::memory_order_relaxed);
+        while (size > current && !bestSize.compare_exchange_weak(current, size, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Greedy coloring: order[] lists candidates by color, bound[] holds the
+    // color count up to and including each entry. Returns the entry count.
+    int colorCandidates(uint64_t candidates, int order[], int bound[]) const {
+        int count = 0;
+        int color = 0;
+        for (uint64_t uncolored = candidates; uncolored;) {
+            ++color;
+            for (uint64_t available = uncolored; available;) {
+                int node = __builtin_ctzll(available);
+                available &= ~(adjacencyMask[node] | bit(node));
+                uncolored &= ~bit(node);
+                order[count] = node;
+                bound[count++] = color;
+            }
+        }
+        return count;
+    }
+
+    void expand(uint64_t candidates, int depth) {
+        int order[64];
+        int bound[64];
+        int count = colorCandidates(candidates, order, bound);
+
+        // Expand from the highest color so the bound tightens as we go
+        for (int i = count - 1; i >= 0; --i) {
+            int best = bestSize.load(std::memory_order_relaxed);
+            if (depth + bound[i] <= best || best >= targetSize) return;
+
+            int node = order[i];
+            uint64_t next = candidates & adjacencyMask[node];
+            if (next) {
+                expand(next, depth + 1);
+            } else {
+                raiseBest(depth + 1);
+            }
+            candidates &= ~bit(node);
+        }
+    }
+
+    void push(int worker, const Task& task) {
+        pendingTasks.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> guard(queues[worker].lock);
+        queues[worker].tasks.push_back(task);
+    }
+
+    bool take(int worker, Task& task) {
+        {
+            std::lock_guard<std::mutex> guard(queues[worker].lock);
+            if (!queues[worker].tasks.empty()) {
+                task = queues[worker].tasks.back();
+                queues[worker].tasks.pop_back();
+                return true;
+            }
+        }
+        for (int offset = 1; offset < threadCount; ++offset) {
+            WorkerQueue& victim = queues[(worker + offset) % threadCount];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void runTask(int worker, const Task& task) {
+        int best = bestSize.load(std::memory_order_relaxed);
+        if (task.bound <= best || best >= targetSize) return;
+        if (task.depth >= SPLIT_DEPTH) {
+            expand(task.candidates, task.depth);
+            return;
+        }
+
+        int order[64];
+        int bound[64];
+        int count = colorCandidates(task.candidates, order, bound);
+        uint64_t candidates = task.candidates;
+        for (int i = count - 1; i >= 0; --i) {
+            int node = order[i];
+            uint64_t next = candidates & adjacencyMask[node];
+            if (next) {
+                push(worker, {next, task.depth + 1, task.depth + bound[i]});
+            } else {
+                raiseBest(task.depth + 1);
+            }
+            candidates &= ~bit(node);
+        }
+    }
+
+    void workerLoop(int worker) {
+        Task task;
+        while (pendingTasks.load(std::memory_order_acquire) > 0) {
+            if (take(worker, task)) {
+                runTask(worker, task);
+                pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+            } else {
+                std::this_thread::yield();
             }
         }
     }
 
+    void poolThread(int worker) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> guard(poolLock);
+        while (true) {
+            searchStarted.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            guard.unlock();
+            workerLoop(worker);
+            guard.lock();
+            if (--runningWorkers == 0) searchFinished.notify_one();
+        }
+    }
+
+    void runParallel(uint64_t candidates) {
+        if (!candidates) return;
+        if (workers.empty()) {
+            for (int worker = 1; worker < threadCount; ++worker) {
+                workers.emplace_back(&MaxCliqueSolver::poolThread, this, worker);
+            }
+        }
+        push(0, {candidates, 0, __builtin_popcountll(candidates)});
+        {
+            std::lock_guard<std::mutex> guard(poolLock);
+            ++generation;
+            runningWorkers = threadCount - 1;
+        }
+        searchStarted.notify_all();
+
+        workerLoop(0);
+        // The next search resets the shared state, so every worker must have
+        // left its loop first
+        std::unique_lock<std::mutex> guard(poolLock);
+        searchFinished.wait(guard, [&] { return runningWorkers == 0; });
+    }
+};
+
+// Find the largest group of fully connected nodes using branch and bound
+std::vector<int> findMaxFullyConnectedGroup(int n, int threadCount = 1) {
+    std::vector<int> largestGroup;
+    if (n == 0) return largestGroup;
+
+    MaxCliqueSolver solver(n, threadCount);
+    for (uint64_t clique = solver.smallestMaximumClique(); clique; clique &= clique - 1) {
+        largestGroup.push_back(__builtin_ctzll(clique));
+    }
     return largestGroup;
 }
 
 // Wrapper to handle complete graphs or fallback to general solutions
-std::vector<int> findLargestGroup(int n) {
+std::vector<int> findLargestGroup(int n, int threadCount = 1) {
     bool isCompleteGraph = true;
 
     // Check if the graph is fully connected
@@ -92,24 +347,86 @@ std::vector<int> findLargestGroup(int n) {
         }
         return largestGroup;
     } else {
-        // Use bitmasking for other cases
-        return findMaxFullyConnectedGroup(n);
+        // Use branch and bound for other cases
+        return findMaxFullyConnectedGroup(n, threadCount);
+    }
+}
+
+// Fill the adjacency matrix with a random symmetric graph of the given density
+void generateGraph(int n, double density, unsigned seed) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution hasEdge(density);
+    for (int i = 0; i < n; ++i) {
+        graph[i][i] = 0;
+        for (int j = i + 1; j < n; ++j) {
+            graph[i][j] = graph[j][i] = hasEdge(generator) ? 1 : 0;
+        }
     }
 }
 
-int main() {
+// Report the speedup of the parallel search at 1, 2, 4, 8, ... threads. A
+// single graph of at most MAX_NODES nodes is solved in about a millisecond,
+// so each measurement solves a batch of random graphs.
+int runScalingBenchmark(int n, double density, int graphCount) {
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Solves the whole batch; returns the seconds spent in the solver
+    auto timeRun = [n, density, graphCount](int threadCount, std::vector<std::vector<int>>& groups) {
+        double seconds = 0;
+        groups.assign(graphCount, {});
+        for (int g = 0; g < graphCount; ++g) {
+            generateGraph(n, density, 2024 + g);
+            auto start = std::chrono::steady_clock::now();
+            groups[g] = findMaxFullyConnectedGroup(n, threadCount);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return seconds;
+    };
+
+    std::vector<std::vector<int>> sequentialGroups;
+    double sequentialSeconds = timeRun(1, sequentialGroups);
+    size_t largest = 0;
+    for (const std::vector<int>& group : sequentialGroups) {
+        largest = std::max(largest, group.size());
+    }
+    std::cout << "nodes " << n << ", density " << density << ", graphs " << graphCount
+              << ", largest clique " << largest << "\n";
+
+    bool identical = true;
+    for (unsigned threads = 1; threads <= std::max(maxThreads, 8u); threads *= 2) {
+        std::vector<std::vector<int>> groups;
+        double seconds = timeRun(threads, groups);
+        bool same = groups == sequentialGroups;
+        identical = identical && same;
+        std::cout << threads << " threads: " << seconds * 1000 << " ms, speedup "
+                  << sequentialSeconds / seconds << (same ? "" : " MISMATCH") << "\n";
+    }
+    return identical ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench") {
+        int n = argc > 2 ? std::min(std::atoi(argv[2]), MAX_NODES) : MAX_NODES;
+        double density = argc > 3 ? std::atof(argv[3]) : 0.95;
+        int graphCount = argc > 4 ? std::max(std::atoi(argv[4]), 1) : 500;
+        return runScalingBenchmark(n, density, graphCount);
+    }
+    int threadCount = mode == "--threads" && argc > 2 ? std::atoi(argv[2]) : 1;
+
+    FastInput input;
     int n;
-    std::cin >> n;
+    input.Read(n);
 
     // Read adjacency matrix
     for (int i = 0; i < n; ++i) {
         for (int j = 0; j < n; ++j) {
-            std::cin >> graph[i][j];
+            input.Read(graph[i][j]);
         }
     }
 
     // Determine the largest group and print the result
-    std::vector<int> largestGroup = findLargestGroup(n);
+    std::vector<int> largestGroup = findLargestGroup(n, threadCount);
     std::sort(largestGroup.begin(), largestGroup.end());
     
     for (size_t i = 0; i < largestGroup.size(); ++i) {
@@ -1,31 +1,102 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
 #include <vector>
 #include <queue>
 #include <climits>
+#include <cstdint>
+#include <algorithm>
+
+#include "csr_graph.h"
+#include "fast_input.h"
 
 using namespace std;
 
-// Graph class with adjacency list representation
+// Undirected graph over a symmetrized CSR adjacency (see csr_graph.h)
 template <typename T>
 class Graph {
  public:
-  explicit Graph(int vertices) { adjacency_list.resize(vertices); }
+  explicit Graph(CsrGraph<T> csr) : adjacency(move(csr)) {}
 
-  void AddEdge(T source, T destination) {
-    adjacency_list[source].push_back(destination);
-    adjacency_list[destination].push_back(source);
+  // Every edge is stored in both directions
+  static Graph FromEdges(const typename CsrGraph<T>::Builder& edges) {
+    return Graph(edges.Build(CsrGraph<T>::kSymmetrize));
   }
 
+  const CsrGraph<T>& Adjacency() const { return adjacency; }
+
+  // One multi-source traversal from all three nodes; a vertex's combined
+  // distance is complete as soon as the last of the three reaches it
   T FindShortestCombinedPath(T src1, T src2, T target, int total_nodes) {
-    vector<T> dist_src1 = PerformBFS(src1, total_nodes);
-    vector<T> dist_src2 = PerformBFS(src2, total_nodes);
-    vector<T> dist_target = PerformBFS(target, total_nodes);
+    const uint64_t all_sources = 0b111;
+    vector<T> distance_sum(total_nodes, 0);
+    T min_distance = INT_MAX;
+
+    PerformMultiSourceBFS({src1, src2, target}, total_nodes,
+                          [&](T vertex, uint64_t reached, uint64_t seen, T level) {
+                            distance_sum[vertex] += level * __builtin_popcountll(reached);
+                            if (seen == all_sources) {
+                              min_distance = min(min_distance, distance_sum[vertex]);
+                            }
+                            // Any vertex completed later is at least one level further away
+                            return min_distance > level + 1;
+                          });
 
-    return ComputeMinDistance(total_nodes, dist_src1, dist_src2, dist_target);
+    return min_distance;
   }
 
- private:
-  vector<vector<T>> adjacency_list;
+  // Bit-parallel BFS from up to 64 sources at once (MS-BFS). Every vertex
+  // keeps a mask of the sources that have reached it, so each adjacency list
+  // is scanned once per level for all sources together. Only the vertices
+  // active in a level are listed and visited, so the whole traversal is
+  // O(V + E) even on high-diameter graphs. `visit(vertex, reached, seen,
+  // level)` is called when the sources in `reached` first arrive at
+  // `vertex`; returning false stops the traversal.
+  template <typename Visitor>
+  void PerformMultiSourceBFS(const vector<T>& sources, int total_nodes, Visitor visit) {
+    vector<uint64_t> seen(total_nodes, 0);
+    vector<uint64_t> frontier(total_nodes, 0);
+    vector<uint64_t> next(total_nodes, 0);
+    vector<T> frontier_vertices;
+    vector<T> next_vertices;
+
+    for (size_t i = 0; i < sources.size() && i < 64; ++i) {
+      if (!frontier[sources[i]]) frontier_vertices.push_back(sources[i]);
+      seen[sources[i]] |= uint64_t(1) << i;
+      frontier[sources[i]] |= uint64_t(1) << i;
+    }
+    for (T vertex : frontier_vertices) {
+      if (!visit(vertex, frontier[vertex], seen[vertex], T(0))) {
+        return;
+      }
+    }
+
+    for (T level = 1; !frontier_vertices.empty(); ++level) {
+      for (T vertex : frontier_vertices) {
+        for (const T& neighbor : adjacency.Neighbors(vertex)) {
+          uint64_t arriving = frontier[vertex] & ~seen[neighbor];
+          if (!arriving) continue;
+          if (!next[neighbor]) next_vertices.push_back(neighbor);
+          next[neighbor] |= arriving;
+        }
+      }
+      for (T vertex : frontier_vertices) frontier[vertex] = 0;
+      frontier_vertices.clear();
+
+      bool keep_going = true;
+      for (T vertex : next_vertices) {
+        seen[vertex] |= next[vertex];
+        keep_going = visit(vertex, next[vertex], seen[vertex], level) && keep_going;
+      }
+      if (!keep_going) return;
+      swap(frontier, next);
+      swap(frontier_vertices, next_vertices);
+    }
+  }
 
   // BFS to calculate shortest distance from a source node
   vector<T> PerformBFS(T start, int total_nodes) {
@@ -39,7 +110,7 @@ class Graph {
       T current = q.front();
       q.pop();
 
-      for (const T& neighbor : adjacency_list[current]) {
+      for (const T& neighbor : adjacency.Neighbors(current)) {
         if (distances[neighbor] == INT_MAX) {
           distances[neighbor] = distances[current] + 1;
           q.push(neighbor);
@@ -50,31 +121,246 @@ class Graph {
     return distances;
   }
 
-  // Compute the minimum combined distance for all nodes
-  static T ComputeMinDistance(int total_nodes, const vector<T>& dist1, const vector<T>& dist2, const vector<T>& dist3) {
-    T min_distance = INT_MAX;
+  // Direction-optimizing BFS (Beamer et al.). Small frontiers expand
+  // top-down from a queue; once the frontier's edges outnumber the
+  // unexplored edges by kAlpha, each unvisited vertex instead looks for any
+  // parent in the frontier bitmap and stops at the first hit. The search
+  // returns to top-down when the frontier shrinks below n / kBeta.
+  // Distances match PerformBFS, with INT_MAX for unreachable vertices.
+  vector<T> PerformDirectionOptimizingBFS(T start) const {
+    const int kAlpha = 15;
+    const int kBeta = 18;
+    const int total_nodes = static_cast<int>(adjacency.GetNumVertices());
+    auto degree = [&](T v) { return adjacency.Degree(v); };
+
+    vector<T> distances(total_nodes, INT_MAX);
+    vector<T> frontier{start};
+    vector<T> next;
+    vector<bool> in_frontier(total_nodes, false);
+    distances[start] = 0;
+
+    size_t unexplored_edges = adjacency.EdgeCount() - degree(start);
+    size_t frontier_edges = degree(start);
+    bool bottom_up = false;
+
+    for (T level = 1; !frontier.empty(); ++level) {
+      if (!bottom_up && frontier_edges > unexplored_edges / kAlpha) {
+        bottom_up = true;
+      } else if (bottom_up && frontier.size() < static_cast<size_t>(total_nodes / kBeta)) {
+        bottom_up = false;
+      }
 
-    for (int i = 0; i < total_nodes; ++i) {
-      if (dist1[i] != INT_MAX && dist2[i] != INT_MAX && dist3[i] != INT_MAX) {
-        min_distance = min(min_distance, dist1[i] + dist2[i] + dist3[i]);
+      next.clear();
+      frontier_edges = 0;
+      if (bottom_up) {
+        for (T v : frontier) in_frontier[v] = true;
+        for (T v = 0; v < total_nodes; ++v) {
+          if (distances[v] != INT_MAX) continue;
+          for (T parent : adjacency.Neighbors(v)) {
+            if (in_frontier[parent]) {
+              distances[v] = level;
+              next.push_back(v);
+              break;
+            }
+          }
+        }
+        for (T v : frontier) in_frontier[v] = false;
+      } else {
+        for (T v : frontier) {
+          for (T neighbor : adjacency.Neighbors(v)) {
+            if (distances[neighbor] == INT_MAX) {
+              distances[neighbor] = level;
+              next.push_back(neighbor);
+            }
+          }
+        }
       }
+
+      for (T v : next) frontier_edges += degree(v);
+      unexplored_edges -= frontier_edges;
+      swap(frontier, next);
     }
 
-    return min_distance;
+    return distances;
   }
+
+ private:
+  CsrGraph<T> adjacency;
 };
 
-int main() {
-  int nodes, edges, leon, matilda, destination;
-  cin >> nodes >> edges >> leon >> matilda >> destination;
+// Random graph with power-law-like degrees: endpoints are drawn with a
+// quadratic bias towards low vertex ids
+CsrGraph<int>::Builder GeneratePowerLawGraph(int nodes, long long edges, unsigned seed) {
+  CsrGraph<int>::Builder graph(nodes);
+  graph.Reserve(edges);
+  mt19937_64 generator(seed);
+  uniform_real_distribution<double> uniform(0.0, 1.0);
+  auto pick = [&]() {
+    double u = uniform(generator);
+    return min(nodes - 1, static_cast<int>(nodes * u * u));
+  };
+  for (long long i = 0; i < edges; ++i) {
+    graph.AddEdge(pick(), pick());
+  }
+  return graph;
+}
+
+// Compares the memory and queue-BFS time of per-vertex adjacency lists
+// with the CSR layout, then the direction-optimizing BFS on the CSR
+int RunBfsBenchmark(int nodes, long long edges) {
+  CsrGraph<int>::Builder edge_list = GeneratePowerLawGraph(nodes, edges, 42);
+  auto seconds_since = [](chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  };
+
+  auto start = chrono::steady_clock::now();
+  Graph<int> graph = Graph<int>::FromEdges(edge_list);
+  double build_seconds = seconds_since(start);
+
+  // The previous representation, filled the way AddEdge used to fill it
+  vector<vector<int>> lists(nodes);
+  for (int v = 0; v < nodes; ++v) {
+    for (int neighbor : graph.Adjacency().Neighbors(v)) lists[v].push_back(neighbor);
+  }
+  size_t list_bytes = lists.capacity() * sizeof(vector<int>);
+  for (const vector<int>& list : lists) list_bytes += list.capacity() * sizeof(int);
+  auto list_bfs = [&](int source) {
+    vector<int> distances(nodes, INT_MAX);
+    queue<int> q;
+    distances[source] = 0;
+    q.push(source);
+    while (!q.empty()) {
+      int current = q.front();
+      q.pop();
+      for (int neighbor : lists[current]) {
+        if (distances[neighbor] == INT_MAX) {
+          distances[neighbor] = distances[current] + 1;
+          q.push(neighbor);
+        }
+      }
+    }
+    return distances;
+  };
+
+  const int kSources = 8;
+  double list_seconds = 0;
+  double queue_seconds = 0;
+  double optimized_seconds = 0;
+  bool identical = true;
+  for (int source = 0; source < nodes && source < kSources; ++source) {
+    start = chrono::steady_clock::now();
+    vector<int> expected = list_bfs(source);
+    list_seconds += seconds_since(start);
+
+    start = chrono::steady_clock::now();
+    vector<int> queue_distances = graph.PerformBFS(source, nodes);
+    queue_seconds += seconds_since(start);
 
-  Graph<int> city_graph(nodes + 1);
+    start = chrono::steady_clock::now();
+    vector<int> optimized_distances = graph.PerformDirectionOptimizingBFS(source);
+    optimized_seconds += seconds_since(start);
+    identical = identical && queue_distances == expected && optimized_distances == expected;
+  }
+
+  cout << "nodes " << nodes << ", edges " << edges << "\n";
+  cout << "csr build:              " << build_seconds * 1000 << " ms\n";
+  cout << "adjacency lists memory: " << list_bytes / 1e6 << " MB (before allocator overhead)\n";
+  cout << "csr memory:             " << graph.Adjacency().MemoryBytes() / 1e6 << " MB\n";
+  cout << "queue bfs, lists:       " << list_seconds * 1000 / kSources << " ms per source\n";
+  cout << "queue bfs, csr:         " << queue_seconds * 1000 / kSources << " ms per source\n";
+  cout << "direction-optimizing:   " << optimized_seconds * 1000 / kSources << " ms per source\n";
+  cout << "distances:              " << (identical ? "identical" : "MISMATCH") << "\n";
+
+  // High-diameter case: on a path every BFS level holds a single vertex, so
+  // a traversal that scans all vertices per level would be quadratic
+  CsrGraph<int>::Builder path_edges(nodes);
+  for (int v = 0; v + 1 < nodes; ++v) path_edges.AddEdge(v, v + 1);
+  Graph<int> path = Graph<int>::FromEdges(path_edges);
+  int first = 0, middle = nodes / 2, last = nodes - 1;
+
+  start = chrono::steady_clock::now();
+  int combined = path.FindShortestCombinedPath(first, middle, last, nodes);
+  double combined_seconds = seconds_since(start);
+
+  vector<int> from_first = path.PerformBFS(first, nodes);
+  vector<int> from_middle = path.PerformBFS(middle, nodes);
+  vector<int> from_last = path.PerformBFS(last, nodes);
+  int expected_combined = INT_MAX;
+  for (int v = 0; v < nodes; ++v) {
+    expected_combined = min(expected_combined, from_first[v] + from_middle[v] + from_last[v]);
+  }
+  bool path_identical = combined == expected_combined;
+  cout << "path of " << nodes << " nodes, combined multi-source bfs: " << combined_seconds * 1000 << " ms"
+       << (path_identical ? "" : " MISMATCH") << "\n";
+  return identical && path_identical ? 0 : 1;
+}
+
+// Ingest throughput on a whitespace-separated integer file, such as an edge
+// list: istream extraction against FastInput's block reader and mmap path
+int RunIngestBenchmark(const char* path) {
+  auto mb_per_second = [path](auto read_all) {
+    auto start = chrono::steady_clock::now();
+    auto [count, checksum, bytes] = read_all(path);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return make_tuple(count, checksum, bytes / 1e6 / seconds);
+  };
+
+  auto [stream_count, stream_checksum, stream_rate] = mb_per_second([](const char* file) {
+    ifstream in(file);
+    long long value, count = 0, checksum = 0;
+    while (in >> value) {
+      ++count;
+      checksum += value;
+    }
+    in.clear();
+    return make_tuple(count, checksum, static_cast<double>(in.seekg(0, ios::end).tellg()));
+  });
+  auto fast_input = [](bool allow_map) {
+    return [allow_map](const char* file) {
+      FastInput in(file, allow_map);
+      long long value, count = 0, checksum = 0;
+      while (in.Read(value)) {
+        ++count;
+        checksum += value;
+      }
+      return make_tuple(count, checksum, static_cast<double>(in.BytesConsumed()));
+    };
+  };
+  auto [block_count, block_checksum, block_rate] = mb_per_second(fast_input(false));
+  auto [map_count, map_checksum, map_rate] = mb_per_second(fast_input(true));
+
+  bool identical = block_count == stream_count && map_count == stream_count &&
+                   block_checksum == stream_checksum && map_checksum == stream_checksum;
+  cout << "integers:          " << stream_count << "\n";
+  cout << "istream:           " << stream_rate << " MB/s\n";
+  cout << "fast input blocks: " << block_rate << " MB/s\n";
+  cout << "fast input mmap:   " << map_rate << " MB/s\n";
+  cout << "checksums:         " << (identical ? "match" : "MISMATCH") << "\n";
+  return identical ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && string(argv[1]) == "--bench") {
+    int nodes = argc > 2 ? atoi(argv[2]) : 1000000;
+    long long edges = argc > 3 ? atoll(argv[3]) : 16LL * nodes;
+    return RunBfsBenchmark(nodes, edges);
+  }
+  if (argc > 2 && string(argv[1]) == "--bench-ingest") {
+    return RunIngestBenchmark(argv[2]);
+  }
+
+  FastInput input;
+  int nodes, edges, leon, matilda, destination;
+  input.Read(nodes, edges, leon, matilda, destination);
 
+  CsrGraph<int>::Builder edge_list(nodes + 1);
+  edge_list.Reserve(edges);
   for (int i = 0; i < edges; ++i) {
     int u, v;
-    cin >> u >> v;
-    city_graph.AddEdge(u, v);
+    input.Read(u, v);
+    edge_list.AddEdge(u, v);
   }
+  Graph<int> city_graph = Graph<int>::FromEdges(edge_list);
 
   cout << city_graph.FindShortestCombinedPath(leon, matilda, destination, nodes + 1);
   return 0;
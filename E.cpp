@@ -1,21 +1,68 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>  
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "csr_graph.h"
+#include "fast_input.h"
 
 using namespace std;
 
 template <typename T>
 class TopologicalSort {
  public:
-  TopologicalSort(int vertex_count)
-      : vertex_count(vertex_count), adjacency_list(vertex_count), in_degrees(vertex_count, 0) {}
+  // Edges are collected and laid out as a CSR graph (see csr_graph.h) the
+  // first time a sort runs. In dynamic mode AddEdge instead keeps a
+  // topological order up to date after every insert (Pearce-Kelly) and
+  // rejects edges that would close a cycle; the incremental searches need
+  // growable adjacency lists, so that mode keeps them and lays the CSR out
+  // from them when a full sort is requested.
+  TopologicalSort(int vertex_count, bool dynamic = false)
+      : vertex_count(vertex_count), edge_list(dynamic ? 0 : vertex_count), in_degrees(vertex_count, 0),
+        dynamic(dynamic) {
+    if (dynamic) {
+      adjacency_list.resize(vertex_count);
+      reverse_adjacency_list.resize(vertex_count);
+      order.resize(vertex_count);
+      position.resize(vertex_count);
+      marked.assign(vertex_count, false);
+      for (T i = 0; i < vertex_count; ++i) {
+        order[i] = i;
+        position[i] = i;
+      }
+    }
+  }
 
-  void AddEdge(T start, T end) {
-    adjacency_list[start].push_back(end);
+  // Returns false if, in dynamic mode, the edge was rejected for closing a cycle
+  bool AddEdge(T start, T end) {
+    if (dynamic && !Reorder(start, end)) {
+      cycle_detected = true;
+      return false;
+    }
     ++in_degrees[end];
+    if (dynamic) {
+      adjacency_list[start].push_back(end);
+      reverse_adjacency_list[end].push_back(start);
+    } else {
+      edge_list.AddEdge(start, end);
+    }
+    built = false;
+    return true;
   }
 
+  // Current order of the dynamic mode; valid for all accepted edges
+  const vector<T>& CurrentOrder() const { return order; }
+
+  bool CycleDetected() const { return cycle_detected; }
+
   bool Sort(vector<int>& result) {
+    Build();
     vector<bool> visited(vertex_count, false);
     vector<bool> recursion_stack(vertex_count, false);
 
@@ -29,16 +76,170 @@ class TopologicalSort {
     return true;
   }
 
+  // Level-synchronous Kahn sort driven by in_degrees. Each zero in-degree
+  // frontier is split across threads; in-degrees are decremented atomically
+  // and newly freed vertices go to per-thread buffers that form the next
+  // frontier. With `deterministic` set every frontier is sorted, so the
+  // order does not depend on thread timing. Returns false on a cycle.
+  bool SortKahn(vector<int>& result, int thread_count, bool deterministic) {
+    const size_t kParallelFrontier = 4096;
+    thread_count = max(thread_count, 1);
+    Build();
+
+    vector<atomic<int>> remaining(vertex_count);
+    vector<T> frontier;
+    for (T i = 0; i < vertex_count; ++i) {
+      remaining[i].store(in_degrees[i], memory_order_relaxed);
+      if (in_degrees[i] == 0) {
+        frontier.push_back(i);
+      }
+    }
+
+    vector<vector<T>> buffers(thread_count);
+    auto process = [&](size_t begin, size_t end, vector<T>& buffer) {
+      for (size_t i = begin; i < end; ++i) {
+        for (T neighbor : graph.Neighbors(frontier[i])) {
+          if (remaining[neighbor].fetch_sub(1, memory_order_acq_rel) == 1) {
+            buffer.push_back(neighbor);
+          }
+        }
+      }
+    };
+
+    while (!frontier.empty()) {
+      result.insert(result.end(), frontier.begin(), frontier.end());
+
+      int workers = frontier.size() < kParallelFrontier ? 1 : thread_count;
+      size_t chunk = (frontier.size() + workers - 1) / workers;
+      vector<thread> threads;
+      for (int w = 1; w < workers; ++w) {
+        size_t begin = min(frontier.size(), w * chunk);
+        size_t end = min(frontier.size(), begin + chunk);
+        threads.emplace_back(process, begin, end, ref(buffers[w]));
+      }
+      process(0, min(frontier.size(), chunk), buffers[0]);
+      for (thread& worker : threads) {
+        worker.join();
+      }
+
+      frontier.clear();
+      for (vector<T>& buffer : buffers) {
+        frontier.insert(frontier.end(), buffer.begin(), buffer.end());
+        buffer.clear();
+      }
+      if (deterministic) {
+        sort(frontier.begin(), frontier.end());
+      }
+    }
+
+    return static_cast<T>(result.size()) == vertex_count;
+  }
+
  private:
   T vertex_count;
-  vector<vector<T>> adjacency_list;
+  typename CsrGraph<T>::Builder edge_list;
+  CsrGraph<T> graph;
+  bool built = false;
   vector<int> in_degrees;
 
+  // Dynamic mode state: order[i] is the vertex at position i
+  bool dynamic;
+  bool cycle_detected = false;
+  vector<vector<T>> adjacency_list;
+  vector<vector<T>> reverse_adjacency_list;
+  vector<T> order;
+  vector<T> position;
+  vector<bool> marked;
+
+  // Collects vertices reachable from `from` whose position lies strictly
+  // inside the window (lower, upper), following forward or reverse edges.
+  // Returns false if `stop` is reached.
+  bool CollectAffected(T from, T stop, T lower, T upper, bool forward, vector<T>& affected) {
+    vector<T> stack{from};
+    marked[from] = true;
+    affected.push_back(from);
+    while (!stack.empty()) {
+      T node = stack.back();
+      stack.pop_back();
+      for (T next : forward ? adjacency_list[node] : reverse_adjacency_list[node]) {
+        if (next == stop) {
+          return false;
+        }
+        if (!marked[next] && position[next] > lower && position[next] < upper) {
+          marked[next] = true;
+          affected.push_back(next);
+          stack.push_back(next);
+        }
+      }
+    }
+    return true;
+  }
+
+  // Pearce-Kelly reordering for a new edge start -> end. Only vertices whose
+  // positions lie between end and start are searched, so the cost is
+  // proportional to the affected region rather than the whole graph.
+  bool Reorder(T start, T end) {
+    if (start == end) {
+      return false;
+    }
+    T lower = position[end];
+    T upper = position[start];
+    if (lower > upper) {
+      return true;
+    }
+
+    vector<T> forward;
+    vector<T> backward;
+    bool acyclic = CollectAffected(end, start, lower, upper, true, forward);
+    if (acyclic) {
+      CollectAffected(start, end, lower, upper, false, backward);
+    }
+    for (T node : forward) marked[node] = false;
+    for (T node : backward) marked[node] = false;
+    if (!acyclic) {
+      return false;
+    }
+
+    // Reuse the freed positions: everything that reaches start goes before
+    // everything reachable from end, each group keeping its relative order
+    auto by_position = [&](T a, T b) { return position[a] < position[b]; };
+    sort(backward.begin(), backward.end(), by_position);
+    sort(forward.begin(), forward.end(), by_position);
+    vector<T> slots;
+    for (T node : backward) slots.push_back(position[node]);
+    for (T node : forward) slots.push_back(position[node]);
+    sort(slots.begin(), slots.end());
+
+    size_t slot = 0;
+    for (const vector<T>* group : {&backward, &forward}) {
+      for (T node : *group) {
+        position[node] = slots[slot];
+        order[slots[slot]] = node;
+        ++slot;
+      }
+    }
+    return true;
+  }
+
+  void Build() {
+    if (built) return;
+    if (dynamic) {
+      typename CsrGraph<T>::Builder accepted_edges(vertex_count);
+      for (T u = 0; u < vertex_count; ++u) {
+        for (T v : adjacency_list[u]) accepted_edges.AddEdge(u, v);
+      }
+      graph = accepted_edges.Build();
+    } else {
+      graph = edge_list.Build();
+    }
+    built = true;
+  }
+
   bool DFS(T node, vector<bool>& visited, vector<bool>& recursion_stack, vector<int>& result) {
     visited[node] = true;
     recursion_stack[node] = true;
 
-    for (T neighbor : adjacency_list[node]) {
+    for (T neighbor : graph.Neighbors(node)) {
       if (!visited[neighbor] && !DFS(neighbor, visited, recursion_stack, result)) {
         return false;
       } else if (recursion_stack[neighbor]) {
@@ -52,20 +253,94 @@ class TopologicalSort {
   }
 };
 
-int main() {
+// Replays a stream of random acyclic edge inserts through the dynamic mode
+// and compares it with re-running a full sort after each insert
+int RunStreamBenchmark(int vertex_count, int edge_count) {
+  mt19937 generator(7);
+  vector<int> hidden_order(vertex_count);
+  for (int i = 0; i < vertex_count; ++i) hidden_order[i] = i;
+  shuffle(hidden_order.begin(), hidden_order.end(), generator);
+  uniform_int_distribution<int> pick(0, vertex_count - 1);
+
+  vector<pair<int, int>> edges;
+  for (int i = 0; i < edge_count; ++i) {
+    int a = pick(generator);
+    int b = pick(generator);
+    if (a == b) continue;
+    if (a > b) swap(a, b);
+    edges.push_back({hidden_order[a], hidden_order[b]});
+  }
+
+  auto start = chrono::steady_clock::now();
+  TopologicalSort<int> dynamic_graph(vertex_count, true);
+  for (const auto& [from, to] : edges) {
+    dynamic_graph.AddEdge(from, to);
+  }
+  double incremental_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  // Full recomputation cost, sampled on the final graph
+  TopologicalSort<int> static_graph(vertex_count);
+  for (const auto& [from, to] : edges) {
+    static_graph.AddEdge(from, to);
+  }
+  const int kSamples = 5;
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < kSamples; ++i) {
+    vector<int> result;
+    static_graph.SortKahn(result, 1, false);
+  }
+  double full_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count() / kSamples;
+
+  vector<int> position(vertex_count);
+  const vector<int>& order = dynamic_graph.CurrentOrder();
+  for (int i = 0; i < vertex_count; ++i) position[order[i]] = i;
+  bool valid = !dynamic_graph.CycleDetected();
+  for (const auto& [from, to] : edges) {
+    valid = valid && position[from] < position[to];
+  }
+
+  cout << "vertices " << vertex_count << ", inserts " << edges.size() << "\n";
+  cout << "incremental: " << incremental_seconds * 1e6 / edges.size() << " us per insert\n";
+  cout << "full resort: " << full_seconds * 1e6 << " us per insert\n";
+  cout << "final order: " << (valid ? "valid" : "INVALID") << "\n";
+  return valid ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && string(argv[1]) == "--bench-stream") {
+    int vertex_count = argc > 2 ? atoi(argv[2]) : 100000;
+    int edge_count = argc > 3 ? atoi(argv[3]) : 4 * vertex_count;
+    return RunStreamBenchmark(vertex_count, edge_count);
+  }
+  // --dynamic maintains the order while edges are read
+  bool use_dynamic = argc > 1 && string(argv[1]) == "--dynamic";
+  // --kahn [threads] [--deterministic] selects the parallel Kahn engine
+  bool use_kahn = argc > 1 && string(argv[1]) == "--kahn";
+  int thread_count = use_kahn && argc > 2 ? atoi(argv[2]) : 1;
+  bool deterministic = argc > 3 && string(argv[3]) == "--deterministic";
+
+  FastInput input;
   int vertex_count, edge_count;
-  cin >> vertex_count >> edge_count;
+  input.Read(vertex_count, edge_count);
 
-  TopologicalSort<int> graph(vertex_count);
+  TopologicalSort<int> graph(vertex_count, use_dynamic);
   vector<int> sorted_vertices;
 
   for (int i = 0; i < edge_count; ++i) {
     int source, destination;
-    cin >> source >> destination;
+    input.Read(source, destination);
     graph.AddEdge(source, destination);
   }
 
-  if (graph.Sort(sorted_vertices)) {
+  bool sorted;
+  if (use_dynamic) {
+    sorted = !graph.CycleDetected();
+    sorted_vertices = graph.CurrentOrder();
+  } else {
+    sorted = use_kahn ? graph.SortKahn(sorted_vertices, thread_count, deterministic)
+                      : graph.Sort(sorted_vertices);
+  }
+  if (sorted) {
     cout << "YES" << endl;
     for (int vertex : sorted_vertices) {
       cout << vertex << " ";
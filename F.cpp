@@ -1,74 +1,258 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
-#include <stack>
 #include <unordered_map>
 #include <algorithm>
 
+#include "csr_graph.h"
+#include "fast_input.h"
+
+// Directed graph over a CSR adjacency (see csr_graph.h)
 template <typename T>
 class Graph {
  public:
-  explicit Graph(int vertices)
-      : total_vertices(vertices),
-        adjacency_list(vertices),
-        reverse_adjacency_list(vertices) {}
-
-  void AddEdge(T source, T destination) {
-    adjacency_list[source].push_back(destination);
-    reverse_adjacency_list[destination].push_back(source);
-  }
+  explicit Graph(CsrGraph<T> adjacency)
+      : total_vertices(adjacency.GetNumVertices()),
+        adjacency_list(std::move(adjacency)) {}
 
-  std::vector<std::vector<T>> FindStronglyConnectedComponents() {
-    std::vector<bool> visited(total_vertices, false);
-    std::stack<T> finish_order;
+  // Iterative Tarjan: one pass over the forward edges with an explicit call
+  // stack, so deep graphs cannot overflow the native stack. Returns the
+  // component id of every vertex and sets `component_count`.
+  std::vector<int> FindStronglyConnectedComponents(int& component_count) {
+    const int kUnvisited = -1;
+    std::vector<int> index(total_vertices, kUnvisited);
+    std::vector<int> low_link(total_vertices, 0);
+    std::vector<int> component(total_vertices, kUnvisited);
+    std::vector<T> scc_stack;
+    std::vector<std::pair<T, size_t>> call_stack;  // vertex, next edge to scan
+    int next_index = 0;
+    component_count = 0;
 
-    // Perform the first DFS pass to compute finish order
-    for (T i = 0; i < total_vertices; ++i) {
-      if (!visited[i]) {
-        PerformDFS(i, visited, finish_order);
-      }
-    }
+    for (T root = 0; root < total_vertices; ++root) {
+      if (index[root] != kUnvisited) continue;
 
-    // Reset visited for the second DFS pass
-    visited.assign(total_vertices, false);
-    std::vector<std::vector<T>> scc_list;
+      index[root] = low_link[root] = next_index++;
+      scc_stack.push_back(root);
+      call_stack.push_back({root, 0});
 
-    // Process nodes in reverse finish order to find SCCs
-    while (!finish_order.empty()) {
-      T current = finish_order.top();
-      finish_order.pop();
+      while (!call_stack.empty()) {
+        auto& [vertex, edge] = call_stack.back();
+        if (edge < adjacency_list.Degree(vertex)) {
+          T neighbor = adjacency_list.Neighbors(vertex)[edge++];
+          if (index[neighbor] == kUnvisited) {
+            index[neighbor] = low_link[neighbor] = next_index++;
+            scc_stack.push_back(neighbor);
+            call_stack.push_back({neighbor, 0});
+          } else if (component[neighbor] == kUnvisited) {
+            // Still on the SCC stack
+            low_link[vertex] = std::min(low_link[vertex], index[neighbor]);
+          }
+          continue;
+        }
 
-      if (!visited[current]) {
-        std::vector<T> scc;
-        PerformReverseDFS(current, visited, scc);
-        scc_list.push_back(scc);
+        T finished = vertex;
+        call_stack.pop_back();
+        if (!call_stack.empty()) {
+          T parent = call_stack.back().first;
+          low_link[parent] = std::min(low_link[parent], low_link[finished]);
+        }
+        if (low_link[finished] == index[finished]) {
+          T member;
+          do {
+            member = scc_stack.back();
+            scc_stack.pop_back();
+            component[member] = component_count;
+          } while (member != finished);
+          ++component_count;
+        }
       }
     }
 
-    return scc_list;
+    return component;
   }
 
-  Graph<T> CondenseGraph(const std::vector<std::vector<T>>& scc_list) {
-    int new_vertex_count = scc_list.size();
-    Graph<T> condensed_graph(new_vertex_count);
-    std::vector<int> vertex_to_component(total_vertices, -1);
+  // Multi-threaded SCC decomposition with the same partition as the
+  // sequential path. Vertices with no remaining in- or out-edges are first
+  // trimmed off as singleton components; the rest is split by
+  // forward-backward search: the vertices both reachable from a pivot and
+  // reaching it form its SCC, and the three leftover parts become
+  // independent tasks for a shared worker pool.
+  std::vector<int> FindStronglyConnectedComponentsParallel(int& component_count, int thread_count) {
+    const int kTrimmed = -1;
+    const size_t kParallelThreshold = 4096;
+    thread_count = std::max(thread_count, 1);
 
-    for (size_t i = 0; i < scc_list.size(); ++i) {
-      for (T vertex : scc_list[i]) {
-        vertex_to_component[vertex] = static_cast<int>(i);
+    // The backward searches and trimming walk in-edges
+    if (!adjacency_list.HasReverse()) adjacency_list.BuildReverse();
+
+    std::vector<int> component(total_vertices, kTrimmed);
+    std::atomic<int> next_component{0};
+    std::atomic<int> next_color{1};
+    std::vector<std::atomic<int>> color(total_vertices);
+    std::vector<std::atomic<int>> in_degree(total_vertices);
+    std::vector<std::atomic<int>> out_degree(total_vertices);
+
+    // Runs body(begin, end, worker) over [0, count), in parallel for large ranges
+    auto parallel_for = [&](size_t count, auto body) {
+      int workers = count < kParallelThreshold ? 1 : thread_count;
+      size_t chunk = (count + workers - 1) / workers;
+      std::vector<std::thread> threads;
+      for (int w = 1; w < workers; ++w) {
+        threads.emplace_back([&, w] { body(std::min(count, w * chunk), std::min(count, (w + 1) * chunk), w); });
+      }
+      body(0, std::min(count, chunk), 0);
+      for (std::thread& thread : threads) thread.join();
+    };
+
+    // Trimming, level by level like Kahn's algorithm
+    std::vector<T> frontier;
+    for (T v = 0; v < total_vertices; ++v) {
+      color[v].store(0, std::memory_order_relaxed);
+      in_degree[v].store(adjacency_list.InDegree(v), std::memory_order_relaxed);
+      out_degree[v].store(adjacency_list.Degree(v), std::memory_order_relaxed);
+      if (in_degree[v].load(std::memory_order_relaxed) == 0 || adjacency_list.Degree(v) == 0) {
+        color[v].store(kTrimmed, std::memory_order_relaxed);
+        frontier.push_back(v);
+      }
+    }
+    std::vector<std::vector<T>> buffers(thread_count);
+    while (!frontier.empty()) {
+      for (T v : frontier) component[v] = next_component++;
+      parallel_for(frontier.size(), [&](size_t begin, size_t end, int worker) {
+        auto release = [&](T neighbor, std::vector<std::atomic<int>>& degree) {
+          int expected = 0;
+          if (degree[neighbor].fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+              color[neighbor].compare_exchange_strong(expected, kTrimmed)) {
+            buffers[worker].push_back(neighbor);
+          }
+        };
+        for (size_t i = begin; i < end; ++i) {
+          T v = frontier[i];
+          for (T w : adjacency_list.Neighbors(v)) release(w, in_degree);
+          for (T w : adjacency_list.ReverseNeighbors(v)) release(w, out_degree);
+        }
+      });
+      frontier.clear();
+      for (auto& buffer : buffers) {
+        frontier.insert(frontier.end(), buffer.begin(), buffer.end());
+        buffer.clear();
       }
     }
 
+    // Forward-backward decomposition of what is left; each task owns the
+    // vertices of one color, so per-vertex marks are never shared
+    struct Task {
+      int color;
+      std::vector<T> vertices;
+    };
+    std::vector<char> reached(total_vertices, 0);  // bit 0 forward, bit 1 backward
+    std::mutex queue_lock;
+    std::condition_variable queue_ready;
+    std::vector<Task> tasks;
+    int active_tasks = 0;
+
+    Task remainder{0, {}};
+    for (T v = 0; v < total_vertices; ++v) {
+      if (color[v].load(std::memory_order_relaxed) == 0) remainder.vertices.push_back(v);
+    }
+    if (!remainder.vertices.empty()) {
+      tasks.push_back(std::move(remainder));
+      active_tasks = 1;
+    }
+
+    auto search = [&](const Task& task, char bit, bool forward) {
+      std::vector<T> stack{task.vertices[0]};
+      reached[task.vertices[0]] |= bit;
+      while (!stack.empty()) {
+        T v = stack.back();
+        stack.pop_back();
+        auto visit = [&](T w) {
+          if (color[w].load(std::memory_order_relaxed) == task.color && !(reached[w] & bit)) {
+            reached[w] |= bit;
+            stack.push_back(w);
+          }
+        };
+        for (T w : forward ? adjacency_list.Neighbors(v) : adjacency_list.ReverseNeighbors(v)) visit(w);
+      }
+    };
+
+    auto split = [&](const Task& task, std::vector<Task>& subtasks) {
+      search(task, 1, true);
+      search(task, 2, false);
+
+      int scc = next_component++;
+      Task parts[3];
+      for (Task& part : parts) part.color = next_color++;
+      for (T v : task.vertices) {
+        int mark = reached[v];
+        reached[v] = 0;
+        if (mark == 3) {
+          component[v] = scc;
+          color[v].store(kTrimmed, std::memory_order_relaxed);
+          continue;
+        }
+        Task& part = parts[mark];  // 0 unreached, 1 forward only, 2 backward only
+        color[v].store(part.color, std::memory_order_relaxed);
+        part.vertices.push_back(v);
+      }
+      for (Task& part : parts) {
+        if (part.vertices.size() == 1) {
+          component[part.vertices[0]] = next_component++;
+        } else if (!part.vertices.empty()) {
+          subtasks.push_back(std::move(part));
+        }
+      }
+    };
+
+    auto worker_loop = [&]() {
+      std::unique_lock<std::mutex> lock(queue_lock);
+      while (true) {
+        queue_ready.wait(lock, [&] { return !tasks.empty() || active_tasks == 0; });
+        if (tasks.empty()) break;
+        Task task = std::move(tasks.back());
+        tasks.pop_back();
+        lock.unlock();
+
+        std::vector<Task> subtasks;
+        split(task, subtasks);
+
+        lock.lock();
+        active_tasks += static_cast<int>(subtasks.size()) - 1;
+        for (Task& subtask : subtasks) tasks.push_back(std::move(subtask));
+        queue_ready.notify_all();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (int w = 1; w < thread_count; ++w) workers.emplace_back(worker_loop);
+    worker_loop();
+    for (std::thread& worker : workers) worker.join();
+
+    component_count = next_component.load();
+    return component;
+  }
+
+  Graph<T> CondenseGraph(const std::vector<int>& vertex_to_component, int component_count) {
+    typename CsrGraph<T>::Builder condensed_edges(component_count);
+
     for (T u = 0; u < total_vertices; ++u) {
-      for (T v : adjacency_list[u]) {
+      for (T v : adjacency_list.Neighbors(u)) {
         int source_component = vertex_to_component[u];
         int dest_component = vertex_to_component[v];
         if (source_component != dest_component) {
-          condensed_graph.AddEdge(source_component, dest_component);
+          condensed_edges.AddEdge(source_component, dest_component);
         }
       }
     }
 
-    return condensed_graph;
+    return Graph<T>(condensed_edges.Build());
   }
 
   std::pair<int, int> CalculateDegrees() {
@@ -76,7 +260,7 @@ class Graph {
     std::vector<int> out_degree(total_vertices, 0);
 
     for (T u = 0; u < total_vertices; ++u) {
-      for (T v : adjacency_list[u]) {
+      for (T v : adjacency_list.Neighbors(u)) {
         out_degree[u]++;
         in_degree[v]++;
       }
@@ -90,53 +274,98 @@ class Graph {
 
  private:
   int total_vertices;
-  std::vector<std::vector<T>> adjacency_list;
-  std::vector<std::vector<T>> reverse_adjacency_list;
-
-  void PerformDFS(T vertex, std::vector<bool>& visited, std::stack<T>& finish_order) {
-    visited[vertex] = true;
-    for (T neighbor : adjacency_list[vertex]) {
-      if (!visited[neighbor]) {
-        PerformDFS(neighbor, visited, finish_order);
-      }
-    }
-    finish_order.push(vertex);
+  CsrGraph<T> adjacency_list;
+};
+
+// Relabel components by first appearance so two partitions compare equal
+std::vector<int> CanonicalPartition(const std::vector<int>& component) {
+  std::unordered_map<int, int> relabel;
+  std::vector<int> canonical(component.size());
+  for (size_t v = 0; v < component.size(); ++v) {
+    auto it = relabel.emplace(component[v], static_cast<int>(relabel.size())).first;
+    canonical[v] = it->second;
   }
+  return canonical;
+}
 
-  void PerformReverseDFS(T vertex, std::vector<bool>& visited, std::vector<T>& scc) {
-    visited[vertex] = true;
-    scc.push_back(vertex);
-    for (T neighbor : reverse_adjacency_list[vertex]) {
-      if (!visited[neighbor]) {
-        PerformReverseDFS(neighbor, visited, scc);
-      }
-    }
+// Random city graph: paths of 1000 vertices plus random extra edges.
+// Compares Tarjan with the parallel mode at 1, 2, 4, 8, ... threads.
+int RunSccBenchmark(int vertices, long long edges) {
+  CsrGraph<int>::Builder edge_list(vertices);
+  std::mt19937_64 generator(99);
+  std::uniform_int_distribution<int> pick(0, vertices - 1);
+  for (int v = 0; v + 1 < vertices; ++v) {
+    if (v % 1000 != 999) edge_list.AddEdge(v, v + 1);
   }
-};
+  for (long long i = 0; i < edges; ++i) {
+    edge_list.AddEdge(pick(generator), pick(generator));
+  }
+  Graph<int> graph(edge_list.Build(CsrGraph<int>::kReverse));
 
-int main() {
-  int vertices, edges;
-  std::cin >> vertices >> edges;
+  auto time_run = [](auto run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  int sequential_count = 0;
+  std::vector<int> sequential;
+  double sequential_seconds = time_run([&] { sequential = graph.FindStronglyConnectedComponents(sequential_count); });
+  std::vector<int> expected = CanonicalPartition(sequential);
+  std::cout << "vertices " << vertices << ", edges " << edges << ", sccs " << sequential_count << "\n";
+  std::cout << "tarjan: " << sequential_seconds * 1000 << " ms\n";
 
-  Graph<int> city_graph(vertices);
+  bool identical = true;
+  unsigned max_threads = std::max(std::thread::hardware_concurrency(), 8u);
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    int count = 0;
+    std::vector<int> parallel;
+    double seconds = time_run([&] { parallel = graph.FindStronglyConnectedComponentsParallel(count, threads); });
+    bool same = count == sequential_count && CanonicalPartition(parallel) == expected;
+    identical = identical && same;
+    std::cout << threads << " threads: " << seconds * 1000 << " ms, speedup vs tarjan "
+              << sequential_seconds / seconds << (same ? "" : " MISMATCH") << "\n";
+  }
+  return identical ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+  std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "--bench") {
+    int vertices = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    long long edges = argc > 3 ? std::atoll(argv[3]) : 2LL * vertices;
+    return RunSccBenchmark(vertices, edges);
+  }
+  int thread_count = mode == "--threads" && argc > 2 ? std::atoi(argv[2]) : 0;
+
+  FastInput input;
+  int vertices, edges;
+  input.Read(vertices, edges);
 
+  CsrGraph<int>::Builder edge_list(vertices);
+  edge_list.Reserve(edges);
   for (int i = 0; i < edges; ++i) {
     int from, to;
-    std::cin >> from >> to;
-    city_graph.AddEdge(from - 1, to - 1);  // Convert to 0-based indexing
+    input.Read(from, to);
+    edge_list.AddEdge(from - 1, to - 1);  // Convert to 0-based indexing
   }
+  // The parallel mode also walks in-edges
+  Graph<int> city_graph(edge_list.Build(thread_count > 0 ? CsrGraph<int>::kReverse : CsrGraph<int>::kDirected));
 
   // Find all strongly connected components (SCCs)
-  auto sccs = city_graph.FindStronglyConnectedComponents();
+  int scc_count = 0;
+  auto scc_ids = thread_count > 0
+                     ? city_graph.FindStronglyConnectedComponentsParallel(scc_count, thread_count)
+                     : city_graph.FindStronglyConnectedComponents(scc_count);
 
   // If there's only one SCC or no edges in the graph
-  if (sccs.size() <= 1) {
+  if (scc_count <= 1) {
     std::cout << 0 << std::endl;
     return 0;
   }
 
   // Create the condensed graph
-  Graph<int> condensed_graph = city_graph.CondenseGraph(sccs);
+  Graph<int> condensed_graph = city_graph.CondenseGraph(scc_ids, scc_count);
 
   // Calculate the in-degrees and out-degrees for the condensed graph
   auto degrees = condensed_graph.CalculateDegrees();
@@ -1,69 +1,360 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <queue>
+#include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <limits>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "alt_landmarks.h"
+#include "csr_graph.h"
+#include "fast_input.h"
+#include "indexed_heap.h"
+#include "monotone_queue.h"
 
 const uint64_t kInf = std::numeric_limits<uint64_t>::max();
 
-class Graph {
+// Explicit weighted graph in CSR form; it is itself a neighbor generator
+using Graph = CsrGraph<uint64_t, uint64_t>;
+
+// The shortest-path routines accept any neighbor generator: a type with
+// GetNumVertices() and ForEachNeighbor(v, visit) calling visit(next, weight)
+// for every outgoing edge of v.
+
+// Implicit lemonade graph: vertex i has an edge to (i + 1) % m of weight a
+// and an edge to (i * i + 1) % m of weight b. Edges are generated on demand,
+// so no adjacency storage is needed.
+class LemonadeGraph {
  private:
-  uint64_t num_vertices_;
-  std::vector<std::vector<std::pair<uint64_t, uint64_t>>> adj_list_;
+  uint64_t a_;
+  uint64_t b_;
+  uint64_t m_;
 
  public:
-  explicit Graph(uint64_t vertices)
-      : num_vertices_(vertices), adj_list_(vertices) {}
+  LemonadeGraph(uint64_t a, uint64_t b, uint64_t m) : a_(a), b_(b), m_(m) {}
 
-  void AddEdge(uint64_t u, uint64_t v, uint64_t weight) {
-    adj_list_[u].emplace_back(v, weight);
+  uint64_t GetNumVertices() const {
+    return m_;
   }
 
-  const std::vector<std::vector<std::pair<uint64_t, uint64_t>>>& GetAdjList() const {
-    return adj_list_;
+  template <typename Visit>
+  void ForEachNeighbor(uint64_t vertex, Visit&& visit) const {
+    visit((vertex + 1) % m_, a_);
+    visit((vertex * vertex + 1) % m_, b_);
   }
+};
 
-  uint64_t GetNumVertices() const {
-    return num_vertices_;
+// Dijkstra over any neighbor generator with a pluggable priority queue from
+// monotone_queue.h; the queue holds (cost, vertex) entries. The search stops
+// as soon as `target` is settled (pass kInf to settle everything) and
+// returns the cost array. `settled`, if given, receives the number of
+// vertices taken off the queue.
+template <typename NeighborGenerator, typename Queue = RadixHeap<uint64_t>>
+std::vector<uint64_t> DijkstraCosts(const NeighborGenerator& graph, uint64_t start, uint64_t target,
+                                    Queue pq = Queue(), uint64_t* settled = nullptr) {
+  std::vector<uint64_t> min_cost(graph.GetNumVertices(), kInf);
+  min_cost[start] = 0;
+
+  pq.Push(0, start);
+
+  while (!pq.Empty()) {
+    auto [current_cost, current_vertex] = pq.Pop();
+
+    if (current_cost > min_cost[current_vertex]) continue;
+    if (settled) ++*settled;
+    if (current_vertex == target) break;
+
+    graph.ForEachNeighbor(current_vertex, [&](uint64_t next_vertex, uint64_t weight) {
+      if (min_cost[next_vertex] > current_cost + weight) {
+        min_cost[next_vertex] = current_cost + weight;
+        pq.Push(min_cost[next_vertex], next_vertex);
+      }
+    });
   }
-};
 
-uint64_t MinBottlesLemonade(const Graph& graph, uint64_t start, uint64_t target) {
+  return min_cost;
+}
+
+template <typename NeighborGenerator, typename Queue = RadixHeap<uint64_t>>
+uint64_t MinBottlesLemonade(const NeighborGenerator& graph, uint64_t start, uint64_t target,
+                            Queue pq = Queue(), uint64_t* settled = nullptr) {
+  if (start == target) return 0;
+
+  std::vector<uint64_t> min_cost = DijkstraCosts(graph, start, target, std::move(pq), settled);
+  return min_cost[target] == kInf ? -1 : min_cost[target];
+}
+
+// A* point-to-point search ordered by cost plus the landmark lower bound.
+// The bound is consistent, so keys still pop in nondecreasing order and the
+// monotone radix heap applies.
+template <typename NeighborGenerator>
+uint64_t MinBottlesLemonadeAlt(const NeighborGenerator& graph, const LandmarkIndex<uint64_t>& landmarks,
+                               uint64_t start, uint64_t target, uint64_t* settled = nullptr) {
   uint64_t num_vertices = graph.GetNumVertices();
   if (start == target) return 0;
 
   std::vector<uint64_t> min_cost(num_vertices, kInf);
   min_cost[start] = 0;
 
-  std::priority_queue<std::pair<uint64_t, uint64_t>, std::vector<std::pair<uint64_t, uint64_t>>, std::greater<>> pq;
-  pq.emplace(0, start);
+  RadixHeap<uint64_t> pq;
+  pq.Push(landmarks.LowerBound(start, target), start);
 
-  while (!pq.empty()) {
-    auto [current_cost, current_vertex] = pq.top();
-    pq.pop();
+  while (!pq.Empty()) {
+    auto [key, current_vertex] = pq.Pop();
+    uint64_t current_cost = key - landmarks.LowerBound(current_vertex, target);
 
     if (current_cost > min_cost[current_vertex]) continue;
+    if (settled) ++*settled;
+    if (current_vertex == target) break;
 
-    for (const auto& [next_vertex, weight] : graph.GetAdjList()[current_vertex]) {
+    graph.ForEachNeighbor(current_vertex, [&](uint64_t next_vertex, uint64_t weight) {
       if (min_cost[next_vertex] > current_cost + weight) {
         min_cost[next_vertex] = current_cost + weight;
-        pq.emplace(min_cost[next_vertex], next_vertex);
+        pq.Push(min_cost[next_vertex] + landmarks.LowerBound(next_vertex, target), next_vertex);
       }
+    });
+  }
+
+  return min_cost[target] == kInf ? -1 : min_cost[target];
+}
+
+// Times the lemonade search with each queue on one large implicit graph,
+// including the indexed d-ary heaps at arity 2, 4 and 8
+int RunQueueBenchmark(uint64_t m) {
+  const uint64_t a = 3;
+  const uint64_t b = 5;
+  LemonadeGraph graph(a, b, m);
+  uint64_t target = m - 1;
+
+  auto time_run = [&](const char* name, auto queue) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t result = MinBottlesLemonade(graph, 1, target, queue);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << seconds * 1000 << " ms (answer " << result << ")\n";
+    return result;
+  };
+
+  std::cout << "m = " << m << ", a = " << a << ", b = " << b << "\n";
+  uint64_t expected = time_run("priority_queue:     ", BinaryHeapQueue<uint64_t>());
+  bool same = time_run("radix heap:         ", RadixHeap<uint64_t>()) == expected;
+  same = time_run("weight-class FIFOs: ", WeightClassQueue<uint64_t>({a, b})) == expected && same;
+  same = time_run("indexed 2-ary heap: ", IndexedDaryHeap<uint64_t, 2>(m)) == expected && same;
+  same = time_run("indexed 4-ary heap: ", IndexedDaryHeap<uint64_t, 4>(m)) == expected && same;
+  same = time_run("indexed 8-ary heap: ", IndexedDaryHeap<uint64_t, 8>(m)) == expected && same;
+  return same ? 0 : 1;
+}
+
+// Bucket width for delta-stepping on the lemonade graph. With only the
+// weights a and b, a width of the smaller weight keeps the light phases
+// short; when the two are close both become light edges and each bucket is
+// settled by a few parallel relaxation rounds. When the weights are far
+// apart the width is kept within kMaxWeightRatio of the heavy one, so a
+// tiny light weight does not spread the frontier over a huge number of
+// nearly empty buckets.
+uint64_t ChooseDelta(uint64_t a, uint64_t b) {
+  const uint64_t kMaxWeightRatio = 64;
+  uint64_t light = std::min(a, b);
+  uint64_t heavy = std::max(a, b);
+  if (light == 0) return std::max<uint64_t>(heavy, 1);
+  return heavy <= 2 * light ? heavy : std::max(light, heavy / kMaxWeightRatio);
+}
+
+// Parallel delta-stepping (Meyer and Sanders). Vertices sit in buckets of
+// width `delta` by tentative cost. The lowest bucket is settled by repeated
+// parallel relaxation of its light edges (weight <= delta), then the heavy
+// edges of everything it settled are relaxed once. Costs are lowered with an
+// atomic min, and the integer fixpoint is the exact shortest-path cost, so
+// the result is identical to DijkstraCosts. Stops once `target` is final
+// (pass kInf to settle everything). Only non-empty buckets are stored, keyed
+// by index, so memory and the bucket scan do not grow with the largest
+// cost divided by delta.
+template <typename NeighborGenerator>
+std::vector<uint64_t> DeltaSteppingCosts(const NeighborGenerator& graph, uint64_t start, uint64_t target,
+                                         uint64_t delta, int thread_count) {
+  const size_t kParallelFrontier = 1024;
+  uint64_t num_vertices = graph.GetNumVertices();
+  delta = std::max<uint64_t>(delta, 1);
+  thread_count = std::max(thread_count, 1);
+
+  std::vector<std::atomic<uint64_t>> cost(num_vertices);
+  for (auto& c : cost) c.store(kInf, std::memory_order_relaxed);
+  cost[start].store(0, std::memory_order_relaxed);
+
+  std::map<uint64_t, std::vector<uint64_t>> buckets{{0, {start}}};
+  std::vector<uint64_t> in_frontier(num_vertices, kInf);  // bucket index of last visit
+  std::vector<std::vector<uint64_t>> improved(thread_count);
+
+  auto lower_cost = [&](uint64_t vertex, uint64_t candidate) {
+    uint64_t current = cost[vertex].load(std::memory_order_relaxed);
+    while (candidate < current) {
+      if (cost[vertex].compare_exchange_weak(current, candidate, std::memory_order_relaxed)) return true;
     }
+    return false;
+  };
+
+  // Relaxes the light or heavy edges of `vertices` on up to thread_count threads
+  auto relax = [&](const std::vector<uint64_t>& vertices, bool light) {
+    int workers = vertices.size() < kParallelFrontier ? 1 : thread_count;
+    size_t chunk = (vertices.size() + workers - 1) / workers;
+    auto work = [&](int worker) {
+      size_t end = std::min(vertices.size(), (worker + 1) * chunk);
+      for (size_t i = worker * chunk; i < end; ++i) {
+        uint64_t base = cost[vertices[i]].load(std::memory_order_relaxed);
+        graph.ForEachNeighbor(vertices[i], [&](uint64_t next, uint64_t weight) {
+          if ((weight <= delta) == light && lower_cost(next, base + weight)) {
+            improved[worker].push_back(next);
+          }
+        });
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; ++w) threads.emplace_back(work, w);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+
+    for (auto& list : improved) {
+      for (uint64_t vertex : list) {
+        buckets[cost[vertex].load(std::memory_order_relaxed) / delta].push_back(vertex);
+      }
+      list.clear();
+    }
+  };
+
+  // Relaxations only ever add to the current bucket or later ones
+  while (!buckets.empty()) {
+    uint64_t index = buckets.begin()->first;
+    std::vector<uint64_t> settled;
+    while (!buckets[index].empty()) {
+      // Keep only vertices still in this bucket, once per round
+      std::vector<uint64_t> frontier;
+      for (uint64_t vertex : buckets[index]) {
+        if (cost[vertex].load(std::memory_order_relaxed) / delta == index && in_frontier[vertex] != index) {
+          in_frontier[vertex] = index;
+          frontier.push_back(vertex);
+        }
+      }
+      buckets[index].clear();
+      for (uint64_t vertex : frontier) in_frontier[vertex] = kInf;
+
+      relax(frontier, true);
+      settled.insert(settled.end(), frontier.begin(), frontier.end());
+    }
+    buckets.erase(index);
+    relax(settled, false);
+
+    if (target < num_vertices && cost[target].load(std::memory_order_relaxed) / delta <= index) break;
   }
 
+  std::vector<uint64_t> result(num_vertices);
+  for (uint64_t v = 0; v < num_vertices; ++v) result[v] = cost[v].load(std::memory_order_relaxed);
+  return result;
+}
+
+uint64_t MinBottlesLemonadeDeltaStepping(const LemonadeGraph& graph, uint64_t start, uint64_t target,
+                                         uint64_t delta, int thread_count) {
+  if (start == target) return 0;
+
+  std::vector<uint64_t> min_cost = DeltaSteppingCosts(graph, start, target, delta, thread_count);
   return min_cost[target] == kInf ? -1 : min_cost[target];
 }
 
-int main() {
+// Full single-source run of delta-stepping at 1, 2, 4, 8, ... threads,
+// checked against the sequential Dijkstra cost array
+int RunDeltaSteppingBenchmark(uint64_t m, uint64_t delta) {
+  const uint64_t a = 3;
+  const uint64_t b = 5;
+  LemonadeGraph graph(a, b, m);
+  if (delta == 0) delta = ChooseDelta(a, b);
+
+  using Clock = std::chrono::steady_clock;
+  auto ms_since = [](Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  };
+
+  auto begin = Clock::now();
+  std::vector<uint64_t> expected = DijkstraCosts(graph, 1, kInf);
+  double sequential_ms = ms_since(begin);
+  std::cout << "m = " << m << ", delta = " << delta << "\n"
+            << "sequential dijkstra: " << sequential_ms << " ms\n";
+
+  bool identical = true;
+  unsigned max_threads = std::max(std::thread::hardware_concurrency(), 8u);
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    begin = Clock::now();
+    std::vector<uint64_t> costs = DeltaSteppingCosts(graph, 1, kInf, delta, threads);
+    double ms = ms_since(begin);
+    bool same = costs == expected;
+    identical = identical && same;
+    std::cout << threads << " threads: " << ms << " ms, speedup " << sequential_ms / ms
+              << (same ? "" : " MISMATCH") << "\n";
+  }
+  return identical ? 0 : 1;
+}
+
+// Answers the query with ALT and reports preprocessing and query timings,
+// against the plain early-exit search, on stderr
+uint64_t RunAltQuery(const LemonadeGraph& graph, size_t landmark_count, uint64_t start, uint64_t target) {
+  using Clock = std::chrono::steady_clock;
+  auto ms_since = [](Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  };
+
+  auto begin = Clock::now();
+  LandmarkIndex<uint64_t> landmarks(graph, graph.GetNumVertices(), landmark_count, 0);
+  double preprocessing_ms = ms_since(begin);
+
+  uint64_t alt_settled = 0;
+  begin = Clock::now();
+  uint64_t result = MinBottlesLemonadeAlt(graph, landmarks, start, target, &alt_settled);
+  double alt_ms = ms_since(begin);
+
+  uint64_t plain_settled = 0;
+  begin = Clock::now();
+  MinBottlesLemonade(graph, start, target, RadixHeap<uint64_t>(), &plain_settled);
+  double plain_ms = ms_since(begin);
+
+  std::cerr << "preprocessing: " << preprocessing_ms << " ms for " << landmarks.Landmarks().size()
+            << " landmarks\n"
+            << "alt query:     " << alt_ms << " ms, " << alt_settled << " of " << graph.GetNumVertices()
+            << " vertices settled\n"
+            << "plain query:   " << plain_ms << " ms, " << plain_settled << " vertices settled\n";
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  std::string mode = argc > 1 ? argv[1] : "";
+  if (mode == "--bench") {
+    return RunQueueBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000);
+  }
+  if (mode == "--bench-delta") {
+    return RunDeltaSteppingBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000,
+                                     argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0);
+  }
+
+  FastInput input;
   uint64_t a, b, m, x, y;
-  std::cin >> a >> b >> m >> x >> y;
+  input.Read(a, b, m, x, y);
 
-  Graph graph(m);
+  LemonadeGraph graph(a, b, m);
+
+  // --threads N [delta] answers with parallel delta-stepping
+  if (mode == "--threads") {
+    int thread_count = argc > 2 ? std::atoi(argv[2]) : 1;
+    uint64_t delta = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : ChooseDelta(a, b);
+    std::cout << MinBottlesLemonadeDeltaStepping(graph, x, y, delta, thread_count) << std::endl;
+    return 0;
+  }
 
-  for (uint64_t i = 0; i < m; ++i) {
-    graph.AddEdge(i, (i + 1) % m, a);
-    graph.AddEdge(i, (i * i + 1) % m, b);
+  // --alt [landmarks] answers with landmark A* and prints a timing report
+  if (mode == "--alt") {
+    size_t landmark_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+    std::cout << RunAltQuery(graph, landmark_count, x, y) << std::endl;
+    return 0;
   }
 
   uint64_t result = MinBottlesLemonade(graph, x, y);
@@ -1,59 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <queue>
+#include <string>
 #include <vector>
 #include <limits>
+#include <utility>
+
+#include "alt_landmarks.h"
+#include "csr_graph.h"
+#include "fast_input.h"
+#include "indexed_heap.h"
+#include "monotone_queue.h"
 
 // Define a constant representing a very large value
 const int kMax = 1e6;
 
-// Struct representing an edge in the graph
-struct Edge {
+// Struct representing an edge in a flat edge array
+struct FlightEdge {
+    int from;  // Source vertex
     int to;    // Destination vertex
     int cost;  // Cost of traveling along this edge
 };
 
-// Class representing a graph
-class Graph {
-private:
-    int num_vertices_; // Number of vertices in the graph
-    std::vector<std::vector<Edge>> adj_list_; // Adjacency list representation
+// Graph over vertices 0..n in CSR form (see csr_graph.h); edge weights are
+// flight costs, and ForEachNeighbor(from, visit) calls visit(to, cost)
+using Graph = CsrGraph<int, int>;
 
+// Indexed heap over (vertex, flights) states for LimitedFlightDijkstra. Each
+// state maps to the id vertex * (k + 1) + flights, so a state is queued at
+// most once and improving it lowers its key in place.
+class FlightStateHeap {
 public:
-    // Constructor initializes the graph with the given number of vertices
-    explicit Graph(int n) : num_vertices_(n), adj_list_(n + 1) {}
+    FlightStateHeap(int n, int k) : stride_(k + 1), heap_(static_cast<size_t>(n + 1) * (k + 1)) {}
 
-    // Adds a directed edge to the graph
-    void AddEdge(int from, int to, int cost) {
-        adj_list_[from].push_back({to, cost});
+    void Push(uint64_t cost, std::pair<int, int> state) {
+        heap_.Push(cost, static_cast<size_t>(state.first) * stride_ + state.second);
     }
 
-    // Returns the adjacency list of the graph
-    const std::vector<std::vector<Edge>>& GetAdjList() const {
-        return adj_list_;
+    std::pair<uint64_t, std::pair<int, int>> Pop() {
+        auto [cost, id] = heap_.Pop();
+        return {cost, {static_cast<int>(id / stride_), static_cast<int>(id % stride_)}};
     }
 
-    // Returns the number of vertices in the graph
-    int GetNumVertices() const {
-        return num_vertices_;
+    bool Empty() const {
+        return heap_.Empty();
     }
+
+private:
+    size_t stride_;
+    IndexedDaryHeap<uint64_t> heap_;
 };
 
-// Function implementing Dijkstra's algorithm with a constraint on the number of flights
-int LimitedFlightDijkstra(int n, const Graph& graph, int k, int start, int end) {
+// Function implementing Dijkstra's algorithm with a constraint on the number of flights.
+// The priority queue is pluggable (see monotone_queue.h); costs are non-negative
+// integers, so the monotone radix heap is the default.
+// `expanded`, if given, receives the number of states taken off the queue.
+template <typename Queue = RadixHeap<std::pair<int, int>>>
+int LimitedFlightDijkstra(int n, const Graph& graph, int k, int start, int end, Queue pq = Queue(),
+                          long long* expanded = nullptr) {
     // Create a 2D vector to track the shortest distances with up to k flights
     std::vector<std::vector<int>> distances(n + 1, std::vector<int>(k + 1, kMax));
     distances[start][0] = 0;
 
-    // Min-heap priority queue to store {current cost, current vertex, flights used}
-    using State = std::tuple<int, int, int>;
-    std::priority_queue<State, std::vector<State>, std::greater<>> pq;
-
-    // Start with the source vertex
-    pq.push({0, start, 0});
+    // Priority queue keyed by current cost, holding {current vertex, flights used}
+    pq.Push(0, {start, 0});
 
-    while (!pq.empty()) {
-        auto [cost, current, flights_taken] = pq.top();
-        pq.pop();
+    while (!pq.Empty()) {
+        auto [key, state] = pq.Pop();
+        int cost = static_cast<int>(key);
+        auto [current, flights_taken] = state;
+        if (expanded) ++*expanded;
 
         // If the destination vertex is reached, return the cost
         if (current == end) {
@@ -61,22 +79,263 @@ int LimitedFlightDijkstra(int n, const Graph& graph, int k, int start, int end)
         }
 
         // Explore all adjacent edges if flights limit allows
-        for (const Edge& edge : graph.GetAdjList()[current]) {
+        graph.ForEachNeighbor(current, [&](int to, int edge_cost) {
             if (flights_taken < k) {
-                int new_cost = cost + edge.cost;
-                if (new_cost < distances[edge.to][flights_taken + 1]) {
-                    distances[edge.to][flights_taken + 1] = new_cost;
-                    pq.push({new_cost, edge.to, flights_taken + 1});
+                int new_cost = cost + edge_cost;
+                if (new_cost < distances[to][flights_taken + 1]) {
+                    distances[to][flights_taken + 1] = new_cost;
+                    pq.Push(new_cost, {to, flights_taken + 1});
+                }
+            }
+        });
+    }
+
+    // If no valid path is found, return -1
+    return -1;
+}
+
+// Hop-limited Bellman-Ford: round j extends every path by one flight, so
+// after k rounds `current[v]` is the cheapest cost with at most k flights.
+// Only two rolling distance buffers of n + 1 ints are kept, and the edges
+// are scanned as one flat array. Costs of kMax or more count as unreachable,
+// as in LimitedFlightDijkstra.
+int LimitedFlightBellmanFord(int n, const std::vector<FlightEdge>& edges, int k, int start, int end) {
+    std::vector<int> previous(n + 1, kMax);
+    previous[start] = 0;
+    std::vector<int> current = previous;
+
+    for (int round = 0; round < k; ++round) {
+        bool changed = false;
+        for (const FlightEdge& edge : edges) {
+            if (previous[edge.from] == kMax) continue;
+            int new_cost = previous[edge.from] + edge.cost;
+            if (new_cost < current[edge.to]) {
+                current[edge.to] = new_cost;
+                changed = true;
+            }
+        }
+        // No path improved, so more flights cannot help either
+        if (!changed) break;
+        previous = current;
+    }
+
+    return current[end] == kMax ? -1 : current[end];
+}
+
+// Struct representing one (start, end, k) fare query
+struct FlightQuery {
+    int start;  // Start vertex
+    int end;    // End vertex
+    int k;      // Maximum number of flights
+};
+
+// Answers many queries against one graph. Queries are grouped by start
+// vertex and each group runs a single Bellman-Ford expansion up to its
+// largest k; after round j the rolling buffer holds the cheapest costs with
+// at most j flights, so every query of the group with k == j is answered
+// right then. Answers are returned in query order.
+std::vector<int> AnswerFlightQueries(int n, const std::vector<FlightEdge>& edges,
+                                     const std::vector<FlightQuery>& queries) {
+    std::vector<int> answers(queries.size(), -1);
+
+    // Query indices sorted by start vertex, then by flight limit
+    std::vector<int> order(queries.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (queries[a].start != queries[b].start) return queries[a].start < queries[b].start;
+        return queries[a].k < queries[b].k;
+    });
+
+    std::vector<int> previous(n + 1);
+    std::vector<int> current(n + 1);
+    size_t group_begin = 0;
+    while (group_begin < order.size()) {
+        int start = queries[order[group_begin]].start;
+        size_t group_end = group_begin;
+        while (group_end < order.size() && queries[order[group_end]].start == start) ++group_end;
+
+        std::fill(current.begin(), current.end(), kMax);
+        current[start] = 0;
+        previous = current;
+
+        int round = 0;
+        bool changed = true;
+        for (size_t i = group_begin; i < group_end; ++i) {
+            const FlightQuery& query = queries[order[i]];
+            // Advance to this query's flight limit unless nothing can improve
+            while (round < query.k && changed) {
+                changed = false;
+                for (const FlightEdge& edge : edges) {
+                    if (previous[edge.from] == kMax) continue;
+                    int new_cost = previous[edge.from] + edge.cost;
+                    if (new_cost < current[edge.to]) {
+                        current[edge.to] = new_cost;
+                        changed = true;
+                    }
                 }
+                previous = current;
+                ++round;
             }
+            answers[order[i]] = current[query.end] == kMax ? -1 : current[query.end];
         }
+        group_begin = group_end;
+    }
+
+    return answers;
+}
+
+// Batch mode: reads n and m, the m edges, then q and q lines of
+// "start end k"; prints one answer per line and the throughput on stderr
+int RunBatch() {
+    std::ios::sync_with_stdio(false);
+
+    FastInput input;
+    int n, m;
+    input.Read(n, m);
+    std::vector<FlightEdge> edges(m);
+    for (FlightEdge& edge : edges) {
+        input.Read(edge.from, edge.to, edge.cost);
+    }
+
+    int q;
+    input.Read(q);
+    std::vector<FlightQuery> queries(q);
+    for (FlightQuery& query : queries) {
+        input.Read(query.start, query.end, query.k);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<int> answers = AnswerFlightQueries(n, edges, queries);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::string output;
+    for (int answer : answers) {
+        output += std::to_string(answer);
+        output += '\n';
+    }
+    std::cout << output;
+    std::cerr << q << " queries in " << seconds * 1000 << " ms, " << q / seconds << " queries/s\n";
+    return 0;
+}
+
+// Dijkstra over (vertex, flights) states with dominance pruning. States are
+// popped by cost, so once vertex v has been popped with h flights, any later
+// state of v with h or more flights costs at least as much and can reach no
+// more: it is discarded. Memory is one int per vertex plus the queue.
+int LimitedFlightPrunedDijkstra(int n, const Graph& graph, int k, int start, int end) {
+    // Fewest flights among the states already popped at each vertex
+    std::vector<int> fewest_flights(n + 1, k + 1);
+
+    // Priority queue keyed by current cost, holding {current vertex, flights used}
+    RadixHeap<std::pair<int, int>> pq;
+    pq.Push(0, {start, 0});
+
+    while (!pq.Empty()) {
+        auto [key, state] = pq.Pop();
+        int cost = static_cast<int>(key);
+        auto [current, flights_taken] = state;
+
+        // If the destination vertex is reached, return the cost
+        if (current == end) {
+            return cost;
+        }
+
+        // Dominated by a cheaper-or-equal state with no more flights
+        if (flights_taken >= fewest_flights[current]) continue;
+        fewest_flights[current] = flights_taken;
+        if (flights_taken == k) continue;
+
+        graph.ForEachNeighbor(current, [&](int to, int edge_cost) {
+            int new_cost = cost + edge_cost;
+            if (new_cost < kMax && flights_taken + 1 < fewest_flights[to]) {
+                pq.Push(new_cost, {to, flights_taken + 1});
+            }
+        });
     }
 
     // If no valid path is found, return -1
     return -1;
 }
 
-int main() {
+// A* variant of LimitedFlightDijkstra. States are ordered by cost plus a
+// landmark lower bound on the remaining cost; the bound ignores the flight
+// limit, which only makes it weaker, so it stays admissible and consistent.
+int LimitedFlightAlt(int n, const Graph& graph, const LandmarkIndex<uint64_t>& landmarks, int k,
+                     int start, int end, long long* expanded = nullptr) {
+    std::vector<std::vector<int>> distances(n + 1, std::vector<int>(k + 1, kMax));
+    distances[start][0] = 0;
+
+    // Keyed by cost plus lower bound, holding {current vertex, flights used}
+    RadixHeap<std::pair<int, int>> pq;
+    pq.Push(landmarks.LowerBound(start, end), {start, 0});
+
+    while (!pq.Empty()) {
+        auto [key, state] = pq.Pop();
+        auto [current, flights_taken] = state;
+        int cost = static_cast<int>(key - landmarks.LowerBound(current, end));
+        if (expanded) ++*expanded;
+
+        // The bound is zero at the destination, so the key is the cost
+        if (current == end) {
+            return cost;
+        }
+
+        graph.ForEachNeighbor(current, [&](int to, int edge_cost) {
+            if (flights_taken < k) {
+                int new_cost = cost + edge_cost;
+                if (new_cost < distances[to][flights_taken + 1]) {
+                    distances[to][flights_taken + 1] = new_cost;
+                    pq.Push(new_cost + landmarks.LowerBound(to, end), {to, flights_taken + 1});
+                }
+            }
+        });
+    }
+
+    // If no valid path is found, return -1
+    return -1;
+}
+
+// Answers the query with ALT and reports preprocessing and query timings,
+// against the plain search, on stderr
+int RunAltQuery(int n, const Graph& graph, int landmark_count, int k, int start, int end) {
+    using Clock = std::chrono::steady_clock;
+    auto ms_since = [](Clock::time_point begin) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    };
+
+    // Vertex 0 is unused, so the farthest-first selection starts at vertex 1
+    auto begin = Clock::now();
+    LandmarkIndex<uint64_t> landmarks(graph, n + 1, landmark_count, 1);
+    double preprocessing_ms = ms_since(begin);
+
+    long long alt_expanded = 0;
+    begin = Clock::now();
+    int result = LimitedFlightAlt(n, graph, landmarks, k, start, end, &alt_expanded);
+    double alt_ms = ms_since(begin);
+
+    long long plain_expanded = 0;
+    begin = Clock::now();
+    LimitedFlightDijkstra(n, graph, k, start, end, RadixHeap<std::pair<int, int>>(), &plain_expanded);
+    double plain_ms = ms_since(begin);
+
+    std::cerr << "preprocessing: " << preprocessing_ms << " ms for " << landmarks.Landmarks().size()
+              << " landmarks\n"
+              << "alt query:     " << alt_ms << " ms, " << alt_expanded << " states expanded\n"
+              << "plain query:   " << plain_ms << " ms, " << plain_expanded << " states expanded\n";
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--batch") {
+        return RunBatch();
+    }
+    // --alt [landmarks] answers with landmark A* and prints a timing report
+    bool use_alt = mode == "--alt";
+    int landmark_count = use_alt && argc > 2 ? std::atoi(argv[2]) : 4;
+    // --engine table|indexed|bellman-ford|pruned selects the hop-limited engine
+    std::string engine = mode == "--engine" && argc > 2 ? argv[2] : "table";
+
     int n;     // Number of vertices
     int m;     // Number of edges
     int k;     // Maximum number of flights
@@ -84,20 +343,40 @@ int main() {
     int end;   // End vertex
 
     // Input the number of vertices, edges, max flights, start, and end vertices
-    std::cin >> n >> m >> k >> start >> end;
+    FastInput input;
+    input.Read(n, m, k, start, end);
 
-    // Initialize the graph
-    Graph graph(n);
+    // The Bellman-Ford engine only needs the flat edge array
+    if (engine == "bellman-ford") {
+        std::vector<FlightEdge> edges(m);
+        for (FlightEdge& edge : edges) {
+            input.Read(edge.from, edge.to, edge.cost);
+        }
+        std::cout << LimitedFlightBellmanFord(n, edges, k, start, end) << std::endl;
+        return 0;
+    }
 
-    // Input the edges of the graph
+    // Input the edges of the graph, then lay them out as CSR
+    Graph::Builder edge_list(n + 1);
+    edge_list.Reserve(m);
     for (int i = 0; i < m; ++i) {
         int from, to, cost;
-        std::cin >> from >> to >> cost;
-        graph.AddEdge(from, to, cost);
+        input.Read(from, to, cost);
+        edge_list.AddEdge(from, to, cost);
     }
+    Graph graph = edge_list.Build();
 
     // Run the limited flight Dijkstra algorithm and print the result
-    int result = LimitedFlightDijkstra(n, graph, k, start, end);
+    int result;
+    if (use_alt) {
+        result = RunAltQuery(n, graph, landmark_count, k, start, end);
+    } else if (engine == "indexed") {
+        result = LimitedFlightDijkstra(n, graph, k, start, end, FlightStateHeap(n, k));
+    } else if (engine == "pruned") {
+        result = LimitedFlightPrunedDijkstra(n, graph, k, start, end);
+    } else {
+        result = LimitedFlightDijkstra(n, graph, k, start, end);
+    }
     std::cout << result << std::endl;
 
     return 0;
@@ -1,77 +1,227 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <queue>
+#include <string>
 #include <vector>
 
-struct Link {
-  int target_node; 
-  double success_rate; 
-};
+#include "alt_landmarks.h"
+#include "csr_graph.h"
+#include "fast_input.h"
+#include "indexed_heap.h"
+#include "monotone_queue.h"
 
-class NetworkGraph {
- private:
-  std::vector<std::vector<Link>> adjacency_list_; 
+// Undirected network in CSR form (see csr_graph.h): every link is stored in
+// both directions with its success rate as the edge weight
+using NetworkGraph = CsrGraph<int, double>;
+
+// Additive view of the network for landmark preprocessing: a link with
+// success rate p costs -log(1 - p), so combining risks along a path becomes
+// a sum, which is what the triangle inequality needs
+class LogRiskView {
  public:
-  explicit NetworkGraph(int num_nodes) : adjacency_list_(num_nodes + 1) {}
+  explicit LogRiskView(const NetworkGraph& graph) : graph_(graph) {}
 
-  void AddEdge(int source, int destination, double success_rate) {
-    adjacency_list_[source].push_back({destination, success_rate});
-    adjacency_list_[destination].push_back({source, success_rate});
+  template <typename Visit>
+  void ForEachNeighbor(int node, Visit&& visit) const {
+    graph_.ForEachNeighbor(node, [&](int target_node, double success_rate) {
+      visit(target_node, -std::log1p(-success_rate));
+    });
   }
 
-  const std::vector<std::vector<Link>>& GetAdjacencyList() const {
-    return adjacency_list_;
-  }
+ private:
+  const NetworkGraph& graph_;
 };
 
-double FindMinimumRisk(const std::vector<std::vector<Link>>& graph, int start_node,
-                        int end_node) {
-  std::vector<double> risk(graph.size(), 1.0); 
+// Stops as soon as end_node is taken off the queue: risk only grows along a
+// path, so its pop carries the final value. The indexed heap lowers a
+// queued node's key in place, so no node is ever popped with an outdated
+// risk. `settled`, if given, receives the number of queue pops.
+double FindMinimumRisk(const NetworkGraph& graph, int start_node,
+                        int end_node, long long* settled = nullptr) {
+  std::vector<double> risk(graph.GetNumVertices(), 1.0); 
+  risk[start_node] = 0.0;
+
+  IndexedDaryHeap<double> pq(graph.GetNumVertices());
+  pq.Push(0.0, start_node);
+
+  while (!pq.Empty()) {
+    auto [current_risk, popped_node] = pq.Pop();
+    int current_node = static_cast<int>(popped_node);
+    if (settled) ++*settled;
+    if (current_node == end_node) break;
+
+    graph.ForEachNeighbor(current_node, [&](int target_node, double success_rate) {
+      double new_risk = current_risk + success_rate -
+                        current_risk * success_rate;
+      if (new_risk < risk[target_node]) {
+        risk[target_node] = new_risk;
+        pq.Push(new_risk, target_node);
+      }
+    });
+  }
+
+  return risk[end_node];
+}
+
+// Fixed-point scale of quantized log-space keys: 2^32 units per nat
+const double kLogRiskScale = 4294967296.0;
+
+// Log-space engine: a link with success rate p becomes the additive cost
+// -log(1 - p), so path risks combine by addition instead of
+// r + p - r * p, and the minimum-risk path is the shortest path. The risk
+// of each tentative path is still combined with the original formula
+// alongside its cost, as in FindMinimumRiskAlt: 1 - exp(-cost) rounds some
+// two-digit ties the other way, so the printed value is taken from the
+// risk. With `quantize` set the queue is ordered by the cost rounded to
+// fixed point, which is monotone along any path, so the integer radix heap
+// applies; the exact cost is still kept per node. Links with p = 1 can
+// never lower a risk and are skipped, as in FindMinimumRisk.
+double FindMinimumRiskLogSpace(const NetworkGraph& graph, int start_node,
+                               int end_node, bool quantize) {
+  std::vector<double> cost(graph.GetNumVertices(), std::numeric_limits<double>::infinity());
+  std::vector<double> risk(graph.GetNumVertices(), 1.0);
+  cost[start_node] = 0.0;
   risk[start_node] = 0.0;
 
-  std::priority_queue<std::pair<double, int>,
-                      std::vector<std::pair<double, int>>,
-                      std::greater<std::pair<double, int>>>
-      pq;
-  pq.push({0.0, start_node});
-
-  while (!pq.empty()) {
-    double current_risk = pq.top().first; 
-    int current_node = pq.top().second; 
-    pq.pop();
-
-    for (const Link& edge : graph[current_node]) {
-      double new_risk = current_risk + edge.success_rate -
-                        current_risk * edge.success_rate;
-      if (new_risk < risk[edge.target_node]) {
-        risk[edge.target_node] = new_risk;
-        pq.push({new_risk, edge.target_node});
+  auto relax = [&](int node, auto&& push) {
+    graph.ForEachNeighbor(node, [&](int target_node, double success_rate) {
+      if (success_rate >= 1.0) return;
+      double new_cost = cost[node] - std::log1p(-success_rate);
+      if (new_cost < cost[target_node]) {
+        cost[target_node] = new_cost;
+        risk[target_node] = risk[node] + success_rate - risk[node] * success_rate;
+        push(new_cost, target_node);
       }
+    });
+  };
+
+  if (quantize) {
+    auto fixed_point = [](double value) { return static_cast<uint64_t>(std::llround(value * kLogRiskScale)); };
+    RadixHeap<int> pq;
+    pq.Push(0, start_node);
+    while (!pq.Empty()) {
+      auto [key, current_node] = pq.Pop();
+      if (key != fixed_point(cost[current_node])) continue;
+      if (current_node == end_node) break;
+      relax(current_node, [&](double new_cost, int node) { pq.Push(fixed_point(new_cost), node); });
+    }
+  } else {
+    IndexedDaryHeap<double> pq(graph.GetNumVertices());
+    pq.Push(0.0, start_node);
+    while (!pq.Empty()) {
+      int current_node = static_cast<int>(pq.Pop().second);
+      if (current_node == end_node) break;
+      relax(current_node, [&](double new_cost, int node) { pq.Push(new_cost, node); });
     }
   }
 
   return risk[end_node];
 }
 
-int main() {
+// A* over the log-space costs with landmark lower bounds. The risk of each
+// tentative path is still combined with the original formula, so the answer
+// matches FindMinimumRisk.
+double FindMinimumRiskAlt(const NetworkGraph& graph,
+                          const LandmarkIndex<double>& landmarks, int start_node,
+                          int end_node, long long* settled = nullptr) {
+  std::vector<double> cost(graph.GetNumVertices(), std::numeric_limits<double>::infinity());
+  std::vector<double> risk(graph.GetNumVertices(), 1.0);
+  cost[start_node] = 0.0;
+  risk[start_node] = 0.0;
+
+  IndexedDaryHeap<double> pq(graph.GetNumVertices());
+  pq.Push(landmarks.LowerBound(start_node, end_node), start_node);
+
+  while (!pq.Empty()) {
+    int current_node = static_cast<int>(pq.Pop().second);
+    if (settled) ++*settled;
+    if (current_node == end_node) break;
+
+    graph.ForEachNeighbor(current_node, [&](int target_node, double success_rate) {
+      double new_cost = cost[current_node] - std::log1p(-success_rate);
+      if (new_cost < cost[target_node]) {
+        cost[target_node] = new_cost;
+        risk[target_node] = risk[current_node] + success_rate -
+                            risk[current_node] * success_rate;
+        pq.Push(new_cost + landmarks.LowerBound(target_node, end_node), target_node);
+      }
+    });
+  }
+
+  return risk[end_node];
+}
+
+// Answers the query with ALT and reports preprocessing and query timings,
+// against the plain early-exit search, on stderr
+double RunAltQuery(const NetworkGraph& graph, int landmark_count,
+                   int start_node, int end_node) {
+  using Clock = std::chrono::steady_clock;
+  auto ms_since = [](Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  };
+
+  // Node 0 is unused, so the farthest-first selection starts at node 1
+  auto begin = Clock::now();
+  LandmarkIndex<double> landmarks(LogRiskView(graph), graph.GetNumVertices(), landmark_count, 1, true);
+  double preprocessing_ms = ms_since(begin);
+
+  long long alt_settled = 0;
+  begin = Clock::now();
+  double result = FindMinimumRiskAlt(graph, landmarks, start_node, end_node, &alt_settled);
+  double alt_ms = ms_since(begin);
+
+  long long plain_settled = 0;
+  begin = Clock::now();
+  FindMinimumRisk(graph, start_node, end_node, &plain_settled);
+  double plain_ms = ms_since(begin);
+
+  std::cerr << "preprocessing: " << preprocessing_ms << " ms for " << landmarks.Landmarks().size()
+            << " landmarks\n"
+            << "alt query:     " << alt_ms << " ms, " << alt_settled << " nodes settled\n"
+            << "plain query:   " << plain_ms << " ms, " << plain_settled << " nodes settled\n";
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  // --alt [landmarks] answers with landmark A* and prints a timing report
+  bool use_alt = argc > 1 && std::string(argv[1]) == "--alt";
+  int landmark_count = use_alt && argc > 2 ? std::atoi(argv[2]) : 4;
+  // --engine log|fixed answers with the log-space engine, optionally with
+  // fixed-point keys
+  std::string engine = argc > 2 && std::string(argv[1]) == "--engine" ? argv[2] : "";
+
   int total_nodes; 
   int total_edges; 
   int start; 
   int finish; 
-  std::cin >> total_nodes >> total_edges >> start >> finish;
+  FastInput input;
+  input.Read(total_nodes, total_edges, start, finish);
 
-  NetworkGraph graph(total_nodes);
+  NetworkGraph::Builder links(total_nodes + 1);
+  links.Reserve(total_edges);
 
   for (int i = 0; i < total_edges; ++i) {
     int from_node; 
     int to_node; 
     double probability;
-    std::cin >> from_node >> to_node >> probability;
-    graph.AddEdge(from_node, to_node, probability / 100.0);
+    input.Read(from_node, to_node, probability);
+    links.AddEdge(from_node, to_node, probability / 100.0);
   }
 
-  const auto& adjacency_list = graph.GetAdjacencyList();
-  double minimum_risk = FindMinimumRisk(adjacency_list, start, finish);
+  const NetworkGraph adjacency_list = links.Build(NetworkGraph::kSymmetrize);
+  double minimum_risk;
+  if (use_alt) {
+    minimum_risk = RunAltQuery(adjacency_list, landmark_count, start, finish);
+  } else if (engine == "log" || engine == "fixed") {
+    minimum_risk = FindMinimumRiskLogSpace(adjacency_list, start, finish, engine == "fixed");
+  } else {
+    minimum_risk = FindMinimumRisk(adjacency_list, start, finish);
+  }
 
   std::cout << std::setprecision(2) << minimum_risk << std::endl;
 
@@ -1,86 +1,749 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <new>
+#include <random>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <string>
 
-const int BITS_IN_BLOCK = 32;
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "fast_input.h"
+
+const int BITS_IN_BLOCK = 64;
+// Rows are padded to whole cache lines so the SIMD kernels need no tail loop
+const size_t BLOCKS_IN_LINE = 64 / sizeof(uint64_t);
+
+// Allocator handing out cache-line aligned storage
+template <typename T>
+struct CacheLineAllocator {
+  using value_type = T;
+
+  CacheLineAllocator() = default;
+  template <typename U>
+  CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(64)));
+  }
+
+  void deallocate(T* pointer, size_t) {
+    ::operator delete(pointer, std::align_val_t(64));
+  }
+
+  template <typename U>
+  bool operator==(const CacheLineAllocator<U>&) const { return true; }
+  template <typename U>
+  bool operator!=(const CacheLineAllocator<U>&) const { return false; }
+};
+
+// Row OR kernels: target |= source over `blocks` 64-bit words, where
+// `blocks` is a multiple of BLOCKS_IN_LINE and both rows are 64-byte aligned
+using OrKernel = void (*)(uint64_t* target, const uint64_t* source, size_t blocks);
+
+void OrScalar(uint64_t* target, const uint64_t* source, size_t blocks) {
+  for (size_t i = 0; i < blocks; ++i) {
+    target[i] |= source[i];
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) void OrAvx2(uint64_t* target, const uint64_t* source, size_t blocks) {
+  for (size_t i = 0; i < blocks; i += 8) {
+    __m256i low = _mm256_or_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(target + i)),
+                                  _mm256_load_si256(reinterpret_cast<const __m256i*>(source + i)));
+    __m256i high = _mm256_or_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(target + i + 4)),
+                                   _mm256_load_si256(reinterpret_cast<const __m256i*>(source + i + 4)));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(target + i), low);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(target + i + 4), high);
+  }
+}
+
+__attribute__((target("avx512f"))) void OrAvx512(uint64_t* target, const uint64_t* source, size_t blocks) {
+  for (size_t i = 0; i < blocks; i += 8) {
+    _mm512_store_si512(target + i, _mm512_or_si512(_mm512_load_si512(target + i), _mm512_load_si512(source + i)));
+  }
+}
+#endif
+
+// Picks the widest kernel the running CPU supports
+OrKernel SelectOrKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return OrAvx512;
+  if (__builtin_cpu_supports("avx2")) return OrAvx2;
+#endif
+  return OrScalar;
+}
+
+const OrKernel kOrRows = SelectOrKernel();
+
+// ASCII expansion of every byte, least significant bit first, so that
+// column j of a row prints at offset j
+struct ByteDigits {
+  char digits[256][8];
+
+  ByteDigits() {
+    for (int byte = 0; byte < 256; ++byte) {
+      for (int bit = 0; bit < 8; ++bit) {
+        digits[byte][bit] = (byte >> bit) & 1 ? '1' : '0';
+      }
+    }
+  }
+};
+
+const ByteDigits kByteDigits;
+
+// Output formats: one '0'/'1' character per bit, or rows packed eight bits
+// to a byte (column j is bit j % 8 of byte j / 8), written raw or as two
+// lowercase hex digits per byte
+enum class OutputFormat { kText, kHex, kBinary };
+
+// Appends the first `bit_count` bits of `blocks` to `out` in `format`
+void AppendBits(const uint64_t* blocks, int bit_count, OutputFormat format, std::string& out) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  int byte_count = (bit_count + 7) / 8;
+  for (int i = 0; i < byte_count; ++i) {
+    unsigned byte = (blocks[i / 8] >> (i % 8 * 8)) & 0xff;
+    switch (format) {
+      case OutputFormat::kText:
+        out.append(kByteDigits.digits[byte], std::min(8, bit_count - i * 8));
+        break;
+      case OutputFormat::kHex:
+        out += kHexDigits[byte >> 4];
+        out += kHexDigits[byte & 0xf];
+        break;
+      case OutputFormat::kBinary:
+        out += static_cast<char>(byte);
+        break;
+    }
+  }
+}
+
+// Collects output in one reusable buffer and hands it to the stream a chunk
+// at a time instead of one character or row at a time
+class OutputBuffer {
+ public:
+  static const size_t kChunkBytes = 1 << 20;
+
+  explicit OutputBuffer(std::ostream& os) : os_(os) {
+    buffer_.reserve(kChunkBytes + 4096);
+  }
+
+  ~OutputBuffer() {
+    Flush();
+  }
+
+  std::string& Buffer() {
+    return buffer_;
+  }
+
+  // Writes the buffer out once it holds at least a chunk
+  void MaybeFlush() {
+    if (buffer_.size() >= kChunkBytes) Flush();
+  }
+
+  void Flush() {
+    os_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+ private:
+  std::ostream& os_;
+  std::string buffer_;
+};
 
 class BitMatrix {
  public:
   explicit BitMatrix(int num_elements)
       : total_bits_(num_elements),
-        storage_((num_elements + BITS_IN_BLOCK - 1) / BITS_IN_BLOCK, 0) {}
+        storage_(PaddedBlocks(num_elements), 0) {}
 
   void Enable(int position) {
-    storage_[position / BITS_IN_BLOCK] |= (1u << (position % BITS_IN_BLOCK));
+    storage_[position / BITS_IN_BLOCK] |= (uint64_t(1) << (position % BITS_IN_BLOCK));
   }
 
   bool IsEnabled(int position) const {
-    return (storage_[position / BITS_IN_BLOCK] & (1u << (position % BITS_IN_BLOCK))) != 0;
+    return (storage_[position / BITS_IN_BLOCK] & (uint64_t(1) << (position % BITS_IN_BLOCK))) != 0;
   }
 
   void Merge(const BitMatrix& other) {
-    for (size_t i = 0; i < storage_.size(); ++i) {
-      storage_[i] |= other.storage_[i];
-    }
+    kOrRows(storage_.data(), other.storage_.data(), storage_.size());
+  }
+
+  const uint64_t* Data() const {
+    return storage_.data();
+  }
+
+  // Number of 64-bit blocks per row, including the cache-line padding
+  size_t BlockCount() const {
+    return storage_.size();
   }
 
   friend std::ostream& operator<<(std::ostream& os, const BitMatrix& matrix) {
-    for (int i = 0; i < matrix.total_bits_; ++i) {
-      os << matrix.IsEnabled(i);
-    }
-    return os;
+    std::string text;
+    AppendBits(matrix.Data(), matrix.total_bits_, OutputFormat::kText, text);
+    return os.write(text.data(), text.size());
+  }
+
+  // Blocks in a row of `num_elements` bits, rounded up to whole cache lines
+  static size_t PaddedBlocks(int num_elements) {
+    size_t blocks = (num_elements + BITS_IN_BLOCK - 1) / BITS_IN_BLOCK;
+    return (blocks + BLOCKS_IN_LINE - 1) / BLOCKS_IN_LINE * BLOCKS_IN_LINE;
   }
 
  private:
   int total_bits_;
-  std::vector<unsigned int> storage_;
+  std::vector<uint64_t, CacheLineAllocator<uint64_t>> storage_;
 };
 
+// Iterative Tarjan. `next_neighbor(vertex, cursor)` returns the first
+// neighbor at or after `cursor` in vertex's adjacency together with the
+// cursor just past it, or a negative neighbor once the adjacency is
+// exhausted. Components are numbered in the order they complete, which is a
+// reverse topological order.
+template <typename NextNeighbor>
+std::vector<int> FindComponents(int num_nodes, NextNeighbor next_neighbor, int& component_count) {
+  const int kUnvisited = -1;
+  std::vector<int> index(num_nodes, kUnvisited);
+  std::vector<int> low_link(num_nodes, 0);
+  std::vector<int> component(num_nodes, kUnvisited);
+  std::vector<int> scc_stack;
+  std::vector<std::pair<int, int>> call_stack;  // vertex, adjacency cursor
+  int next_index = 0;
+  component_count = 0;
+
+  for (int root = 0; root < num_nodes; ++root) {
+    if (index[root] != kUnvisited) continue;
+    index[root] = low_link[root] = next_index++;
+    scc_stack.push_back(root);
+    call_stack.push_back({root, 0});
+
+    while (!call_stack.empty()) {
+      auto& [vertex, cursor] = call_stack.back();
+      auto [neighbor, next_cursor] = next_neighbor(vertex, cursor);
+      if (neighbor >= 0) {
+        cursor = next_cursor;
+        if (index[neighbor] == kUnvisited) {
+          index[neighbor] = low_link[neighbor] = next_index++;
+          scc_stack.push_back(neighbor);
+          call_stack.push_back({neighbor, 0});
+        } else if (component[neighbor] == kUnvisited) {
+          low_link[vertex] = std::min(low_link[vertex], index[neighbor]);
+        }
+        continue;
+      }
+
+      int finished = vertex;
+      call_stack.pop_back();
+      if (!call_stack.empty()) {
+        int parent = call_stack.back().first;
+        low_link[parent] = std::min(low_link[parent], low_link[finished]);
+      }
+      if (low_link[finished] == index[finished]) {
+        int member;
+        do {
+          member = scc_stack.back();
+          scc_stack.pop_back();
+          component[member] = component_count;
+        } while (member != finished);
+        ++component_count;
+      }
+    }
+  }
+  return component;
+}
+
+// Transitive closure over one contiguous, cache-line aligned slab: row i
+// occupies blocks [i * row_blocks_, (i + 1) * row_blocks_).
 class ReachabilityMatrix {
  public:
   explicit ReachabilityMatrix(const std::vector<BitMatrix>& adjacency_list)
-      : num_nodes_(adjacency_list.size()), paths_(adjacency_list) {}
+      : num_nodes_(adjacency_list.size()),
+        row_blocks_(adjacency_list.empty() ? 0 : adjacency_list[0].BlockCount()),
+        paths_(num_nodes_ * row_blocks_) {
+    for (int i = 0; i < num_nodes_; ++i) {
+      std::copy(adjacency_list[i].Data(), adjacency_list[i].Data() + row_blocks_, Row(i));
+    }
+  }
+
+  // Empty matrix to be filled with Enable, so the input can be parsed
+  // straight into the slab without a second copy of the graph
+  explicit ReachabilityMatrix(int num_nodes)
+      : num_nodes_(num_nodes),
+        row_blocks_(BitMatrix::PaddedBlocks(num_nodes)),
+        paths_(num_nodes_ * row_blocks_, 0) {}
+
+  void Enable(int row, int column) {
+    Row(row)[column / BITS_IN_BLOCK] |= uint64_t(1) << (column % BITS_IN_BLOCK);
+  }
+
+  // Picks the closure algorithm from the input density: below one set bit
+  // in kSparseDensity the condensation path does far fewer row ORs than
+  // Warshall's n^2 pivot tests
+  void ComputePaths(int thread_count = 1) {
+    const size_t kSparseDensity = 16;
+    size_t edges = 0;
+    for (uint64_t block : paths_) {
+      edges += __builtin_popcountll(block);
+    }
+    if (edges * kSparseDensity < static_cast<size_t>(num_nodes_) * num_nodes_) {
+      ComputePathsSparse();
+    } else {
+      ComputePathsDense(thread_count);
+    }
+  }
+
+  // Closure through the SCC condensation. Every vertex of a strongly
+  // connected component reaches exactly the same set, so one row per
+  // component is computed, on the condensed DAG in reverse topological
+  // order: a component reaches its out-neighbors and everything they reach,
+  // plus its own members if it contains any edge. Rows are then copied
+  // back out to the member vertices.
+  void ComputePathsSparse() {
+    int component_count = 0;
+    std::vector<int> component = FindComponents(
+        num_nodes_,
+        [this](int vertex, int column) {
+          int neighbor = NextBit(vertex, column);
+          return neighbor < num_nodes_ ? std::make_pair(neighbor, neighbor + 1) : std::make_pair(-1, 0);
+        },
+        component_count);
+
+    // Tarjan numbers components sinks first, so successors are final when
+    // a component is processed
+    std::vector<std::vector<int>> members(component_count);
+    for (int v = 0; v < num_nodes_; ++v) members[component[v]].push_back(v);
+
+    std::vector<uint64_t, CacheLineAllocator<uint64_t>> reach(component_count * row_blocks_, 0);
+    std::vector<int> seen(component_count, -1);
+    for (int c = 0; c < component_count; ++c) {
+      uint64_t* row = reach.data() + c * row_blocks_;
+      bool has_internal_edge = false;
+      for (int u : members[c]) {
+        for (int w = NextBit(u, 0); w < num_nodes_; w = NextBit(u, w + 1)) {
+          int target = component[w];
+          if (target == c) {
+            has_internal_edge = true;
+            continue;
+          }
+          row[w / BITS_IN_BLOCK] |= uint64_t(1) << (w % BITS_IN_BLOCK);
+          if (seen[target] != c) {
+            seen[target] = c;
+            kOrRows(row, reach.data() + target * row_blocks_, row_blocks_);
+          }
+        }
+      }
+      if (has_internal_edge) {
+        for (int u : members[c]) row[u / BITS_IN_BLOCK] |= uint64_t(1) << (u % BITS_IN_BLOCK);
+      }
+    }
 
-  void ComputePaths() {
-    for (int pivot = 0; pivot < num_nodes_; ++pivot) {
-      for (int start = 0; start < num_nodes_; ++start) {
-        if (paths_[start].IsEnabled(pivot)) {
-          paths_[start].Merge(paths_[pivot]);
+    for (int v = 0; v < num_nodes_; ++v) {
+      const uint64_t* row = reach.data() + component[v] * row_blocks_;
+      std::copy(row, row + row_blocks_, Row(v));
+    }
+  }
+
+  // Blocked Warshall. Pivots are taken in tiles of rows that together fit
+  // in L2: the tile's own rows are closed over its pivots first, then every
+  // other row applies all pivots of the tile while those rows stay cached.
+  // Pivot rows only ever gain true paths, so using a tile row that already
+  // includes later pivots of the same tile is still exact. The row updates
+  // of the second phase are independent and are split across threads.
+  void ComputePathsDense(int thread_count = 1) {
+    const size_t kTileBytes = 256 * 1024;
+    const int kParallelRows = 256;
+    if (num_nodes_ == 0) return;
+
+    int tile = static_cast<int>(std::max<size_t>(1, kTileBytes / (row_blocks_ * sizeof(uint64_t))));
+    tile = std::min(tile, num_nodes_);
+    thread_count = std::max(1, std::min(thread_count, num_nodes_ / kParallelRows));
+
+    for (int tile_begin = 0; tile_begin < num_nodes_; tile_begin += tile) {
+      int tile_end = std::min(num_nodes_, tile_begin + tile);
+
+      for (int pivot = tile_begin; pivot < tile_end; ++pivot) {
+        for (int start = tile_begin; start < tile_end; ++start) {
+          if (IsEnabled(start, pivot)) kOrRows(Row(start), Row(pivot), row_blocks_);
         }
       }
+
+      auto update_rows = [&](int worker) {
+        int chunk = (num_nodes_ + thread_count - 1) / thread_count;
+        int end = std::min(num_nodes_, (worker + 1) * chunk);
+        for (int start = worker * chunk; start < end; ++start) {
+          if (start >= tile_begin && start < tile_end) continue;
+          for (int pivot = tile_begin; pivot < tile_end; ++pivot) {
+            if (IsEnabled(start, pivot)) kOrRows(Row(start), Row(pivot), row_blocks_);
+          }
+        }
+      };
+      std::vector<std::thread> workers;
+      for (int worker = 1; worker < thread_count; ++worker) {
+        workers.emplace_back(update_rows, worker);
+      }
+      update_rows(0);
+      for (std::thread& worker : workers) {
+        worker.join();
+      }
     }
   }
 
-  void PrintMatrix() const {
-    for (const auto& row : paths_) {
-      std::cout << row << std::endl;
+  bool operator==(const ReachabilityMatrix& other) const {
+    return num_nodes_ == other.num_nodes_ && paths_ == other.paths_;
+  }
+
+  // Text and hex rows end in a newline; binary rows are packed back to back
+  void PrintMatrix(OutputFormat format = OutputFormat::kText) const {
+    OutputBuffer output(std::cout);
+    for (int i = 0; i < num_nodes_; ++i) {
+      AppendBits(paths_.data() + i * row_blocks_, num_nodes_, format, output.Buffer());
+      if (format != OutputFormat::kBinary) output.Buffer() += '\n';
+      output.MaybeFlush();
     }
   }
 
  private:
   int num_nodes_;
-  std::vector<BitMatrix> paths_;
+  size_t row_blocks_;
+  std::vector<uint64_t, CacheLineAllocator<uint64_t>> paths_;
+
+  uint64_t* Row(int row) {
+    return paths_.data() + row * row_blocks_;
+  }
+
+  // First set column of `row` at or after `from`, or num_nodes_ if none
+  int NextBit(int row, int from) const {
+    if (from >= num_nodes_) return num_nodes_;
+    const uint64_t* data = paths_.data() + row * row_blocks_;
+    size_t block = from / BITS_IN_BLOCK;
+    uint64_t bits = data[block] & (~uint64_t(0) << (from % BITS_IN_BLOCK));
+    while (bits == 0) {
+      if (++block == row_blocks_) return num_nodes_;
+      bits = data[block];
+    }
+    return static_cast<int>(block * BITS_IN_BLOCK + __builtin_ctzll(bits));
+  }
+
+  bool IsEnabled(int row, int column) const {
+    return (paths_[row * row_blocks_ + column / BITS_IN_BLOCK] >> (column % BITS_IN_BLOCK)) & 1;
+  }
 };
 
-int main() {
+// Reachability index for graphs too large for an n x n closure. Strongly
+// connected components are collapsed, and every component of the condensed
+// DAG gets `label_count` GRAIL intervals: one [lowest post-order rank below
+// it, own rank] pair per randomized DFS. If v is reachable from u, then v's
+// interval lies inside u's in every traversal, so a failed containment
+// answers "no" at once. Everything else is settled by a DFS over the DAG
+// that skips children whose intervals already rule the target out. Queries
+// have the closure's meaning, a path of at least one edge, so Reachable(v, v)
+// holds only when v lies on a cycle.
+class ReachabilityIndex {
+ public:
+  ReachabilityIndex(const std::vector<std::vector<int>>& successors, int label_count = 3)
+      : label_count_(label_count) {
+    int num_nodes = successors.size();
+    int component_count = 0;
+    component_ = FindComponents(
+        num_nodes,
+        [&successors](int vertex, int cursor) {
+          return cursor < static_cast<int>(successors[vertex].size())
+                     ? std::make_pair(successors[vertex][cursor], cursor + 1)
+                     : std::make_pair(-1, 0);
+        },
+        component_count);
+
+    // Condensed DAG in CSR form, without duplicate or internal edges
+    std::vector<std::vector<int>> members(component_count);
+    for (int v = 0; v < num_nodes; ++v) members[component_[v]].push_back(v);
+    cyclic_.assign(component_count, false);
+    dag_offsets_.assign(component_count + 1, 0);
+    std::vector<int> seen(component_count, -1);
+    for (int c = 0; c < component_count; ++c) {
+      cyclic_[c] = members[c].size() > 1;
+      for (int u : members[c]) {
+        for (int w : successors[u]) {
+          int target = component_[w];
+          if (target == c) {
+            cyclic_[c] = true;
+          } else if (seen[target] != c) {
+            seen[target] = c;
+            dag_targets_.push_back(target);
+          }
+        }
+      }
+      dag_offsets_[c + 1] = dag_targets_.size();
+    }
+
+    BuildLabels(component_count);
+    visited_.assign(component_count, 0);
+  }
+
+  bool Reachable(int source, int target) const {
+    int from = component_[source];
+    int to = component_[target];
+    if (from == to) return source != target || cyclic_[from];
+    if (!MayReach(from, to)) return false;
+
+    // Pruned DFS; the stamp avoids clearing visited_ between queries
+    if (++stamp_ == 0) {
+      std::fill(visited_.begin(), visited_.end(), 0);
+      stamp_ = 1;
+    }
+    stack_.assign(1, from);
+    visited_[from] = stamp_;
+    while (!stack_.empty()) {
+      int component = stack_.back();
+      stack_.pop_back();
+      for (int i = dag_offsets_[component]; i < dag_offsets_[component + 1]; ++i) {
+        int next = dag_targets_[i];
+        if (next == to) return true;
+        if (visited_[next] == stamp_ || !MayReach(next, to)) continue;
+        visited_[next] = stamp_;
+        stack_.push_back(next);
+      }
+    }
+    return false;
+  }
+
+  int ComponentCount() const {
+    return cyclic_.size();
+  }
+
+  size_t DagEdgeCount() const {
+    return dag_targets_.size();
+  }
+
+  // Bytes held by the index itself, excluding query scratch space
+  size_t SizeInBytes() const {
+    return component_.size() * sizeof(int) + cyclic_.size() / 8 + dag_offsets_.size() * sizeof(int) +
+           dag_targets_.size() * sizeof(int) + labels_.size() * sizeof(Interval);
+  }
+
+ private:
+  struct Interval {
+    int low;
+    int rank;
+  };
+
+  int label_count_;
+  std::vector<int> component_;
+  std::vector<bool> cyclic_;
+  std::vector<int> dag_offsets_;
+  std::vector<int> dag_targets_;
+  std::vector<Interval> labels_;  // label_count_ intervals per component
+  mutable std::vector<unsigned> visited_;
+  mutable unsigned stamp_ = 0;
+  mutable std::vector<int> stack_;
+
+  bool MayReach(int from, int to) const {
+    const Interval* outer = &labels_[from * label_count_];
+    const Interval* inner = &labels_[to * label_count_];
+    for (int i = 0; i < label_count_; ++i) {
+      if (inner[i].low < outer[i].low || inner[i].rank > outer[i].rank) return false;
+    }
+    return true;
+  }
+
+  // One post-order DFS per label, with roots and children visited in a
+  // fresh random order each time so the intervals fail on different pairs
+  void BuildLabels(int component_count) {
+    labels_.resize(static_cast<size_t>(component_count) * label_count_);
+    std::vector<int> shuffled = dag_targets_;
+    std::vector<int> roots(component_count);
+    std::vector<bool> done(component_count);
+    std::vector<std::pair<int, int>> call_stack;  // component, next child slot
+    std::mt19937 generator(2024);
+
+    for (int label = 0; label < label_count_; ++label) {
+      for (int c = 0; c < component_count; ++c) {
+        std::shuffle(shuffled.begin() + dag_offsets_[c], shuffled.begin() + dag_offsets_[c + 1], generator);
+        roots[c] = c;
+      }
+      std::shuffle(roots.begin(), roots.end(), generator);
+      std::fill(done.begin(), done.end(), false);
+      int rank = 0;
+
+      for (int root : roots) {
+        if (done[root]) continue;
+        done[root] = true;
+        call_stack.push_back({root, dag_offsets_[root]});
+        labels_[root * label_count_ + label].low = component_count;
+        while (!call_stack.empty()) {
+          auto& [component, slot] = call_stack.back();
+          Interval& interval = labels_[component * label_count_ + label];
+          if (slot < dag_offsets_[component + 1]) {
+            int child = shuffled[slot++];
+            if (!done[child]) {
+              done[child] = true;
+              labels_[child * label_count_ + label].low = component_count;
+              call_stack.push_back({child, dag_offsets_[child]});
+            } else {
+              interval.low = std::min(interval.low, labels_[child * label_count_ + label].low);
+            }
+            continue;
+          }
+          interval.rank = rank++;
+          interval.low = std::min(interval.low, interval.rank);
+          call_stack.pop_back();
+          if (!call_stack.empty()) {
+            Interval& parent = labels_[call_stack.back().first * label_count_ + label];
+            parent.low = std::min(parent.low, interval.low);
+          }
+        }
+      }
+    }
+  }
+};
+
+// Builds the index from the adjacency rows on stdin and reports its size and
+// build time on stderr. With a query file (a count followed by that many
+// "u v" pairs) it prints one 0/1 answer per query and the query rate;
+// without one it prints the full matrix, answered one query per cell.
+int RunIndex(const char* query_path) {
+  using Clock = std::chrono::steady_clock;
+  auto ms_since = [](Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  };
+
+  FastInput input;
+  int node_count;
+  input.Read(node_count);
+  std::vector<std::vector<int>> successors(node_count);
+  std::string_view row;
+  for (int i = 0; i < node_count; ++i) {
+    input.Read(row);
+    for (int j = 0; j < node_count; ++j) {
+      if (row[j] == '1') successors[i].push_back(j);
+    }
+  }
+
+  auto begin = Clock::now();
+  ReachabilityIndex index(successors);
+  double build_ms = ms_since(begin);
+  std::cerr << "index: " << index.ComponentCount() << " components, " << index.DagEdgeCount()
+            << " dag edges, " << index.SizeInBytes() << " bytes (closure matrix "
+            << static_cast<size_t>(node_count) * node_count / 8 << " bytes), built in " << build_ms << " ms\n";
+
+  if (query_path == nullptr) {
+    OutputBuffer output(std::cout);
+    for (int i = 0; i < node_count; ++i) {
+      for (int j = 0; j < node_count; ++j) {
+        output.Buffer() += index.Reachable(i, j) ? '1' : '0';
+      }
+      output.Buffer() += '\n';
+      output.MaybeFlush();
+    }
+    return 0;
+  }
+
+  std::ifstream query_file(query_path);
+  if (!query_file) {
+    std::cerr << "cannot open " << query_path << "\n";
+    return 1;
+  }
+  int query_count;
+  query_file >> query_count;
+  std::vector<std::pair<int, int>> queries(query_count);
+  for (auto& [source, target] : queries) {
+    query_file >> source >> target;
+  }
+
+  std::string output;
+  begin = Clock::now();
+  for (const auto& [source, target] : queries) {
+    output += index.Reachable(source, target) ? "1\n" : "0\n";
+  }
+  double query_ms = ms_since(begin);
+  std::cout << output;
+  std::cerr << "queries: " << query_count << " in " << query_ms << " ms, "
+            << (query_ms > 0 ? query_count / (query_ms / 1000) : 0) << " queries/s\n";
+  return 0;
+}
+
+// Times the dense and sparse closure paths on random matrices of
+// decreasing density and checks that both produce the same matrix
+int RunDensityBenchmark(int node_count) {
+  std::mt19937_64 generator(17);
+  std::cout << "nodes " << node_count << "\n";
+  bool identical = true;
+  for (double density : {0.1, 0.01, 0.001, 0.0001}) {
+    std::bernoulli_distribution has_edge(density);
+    std::vector<BitMatrix> adjacency_list(node_count, BitMatrix(node_count));
+    for (int i = 0; i < node_count; ++i) {
+      for (int j = 0; j < node_count; ++j) {
+        if (has_edge(generator)) adjacency_list[i].Enable(j);
+      }
+    }
+
+    auto time_run = [](ReachabilityMatrix& matrix, auto compute) {
+      auto start = std::chrono::steady_clock::now();
+      compute(matrix);
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    ReachabilityMatrix dense(adjacency_list);
+    ReachabilityMatrix sparse(adjacency_list);
+    double dense_ms = time_run(dense, [](ReachabilityMatrix& m) { m.ComputePathsDense(); });
+    double sparse_ms = time_run(sparse, [](ReachabilityMatrix& m) { m.ComputePathsSparse(); });
+    bool same = dense == sparse;
+    identical = identical && same;
+    std::cout << "density " << density << ": dense " << dense_ms << " ms, sparse " << sparse_ms
+              << " ms" << (same ? "" : " MISMATCH") << "\n";
+  }
+  return identical ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    return RunDensityBenchmark(argc > 2 ? std::atoi(argv[2]) : 4000);
+  }
+  // --index [queries] answers from the compressed reachability index
+  if (argc > 1 && std::string(argv[1]) == "--index") {
+    return RunIndex(argc > 2 ? argv[2] : nullptr);
+  }
+
+  // --threads N spreads the closure's row updates over N threads;
+  // --format text|hex|binary selects the output encoding
+  int thread_count = 1;
+  OutputFormat format = OutputFormat::kText;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string option = argv[i];
+    std::string value = argv[i + 1];
+    if (option == "--threads") {
+      thread_count = std::atoi(value.c_str());
+    } else if (option == "--format") {
+      format = value == "hex" ? OutputFormat::kHex : value == "binary" ? OutputFormat::kBinary : OutputFormat::kText;
+    }
+  }
+
+  FastInput input;
   int node_count;
-  std::cin >> node_count;
+  input.Read(node_count);
 
-  std::vector<BitMatrix> adjacency_list(node_count, BitMatrix(node_count));
+  ReachabilityMatrix reachability(node_count);
 
   for (int i = 0; i < node_count; ++i) {
-    std::string input;
-    std::cin >> input;
+    std::string_view row;
+    input.Read(row);
     for (int j = 0; j < node_count; ++j) {
-      if (input[j] == '1') {
-        adjacency_list[i].Enable(j);
+      if (row[j] == '1') {
+        reachability.Enable(i, j);
       }
     }
   }
 
-  ReachabilityMatrix reachability(adjacency_list);
-  reachability.ComputePaths();
-  reachability.PrintMatrix();
+  reachability.ComputePaths(thread_count);
+  reachability.PrintMatrix(format);
 
   return 0;
 }
@@ -0,0 +1,105 @@
+#ifndef ALT_LANDMARKS_H_
+#define ALT_LANDMARKS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Landmark lower bounds for goal-directed (A*) point-to-point search, the
+// "ALT" scheme: exact shortest-path distances from a few landmarks are
+// computed once per graph, and the triangle inequality
+//
+//   d(L, target) <= d(L, v) + d(v, target)
+//
+// turns them into a consistent lower bound on d(v, target). Graphs are given
+// as neighbor generators: ForEachNeighbor(v, visit) calls visit(next, weight)
+// for every outgoing edge of v. Only forward distances from the landmarks are
+// needed, so implicit graphs whose reverse edges are unknown still work; for
+// undirected graphs `symmetric` also applies the mirrored bound.
+template <typename Cost>
+class LandmarkIndex {
+ public:
+  static constexpr Cost kUnreachable = std::numeric_limits<Cost>::max();
+
+  // Landmarks are picked farthest-first, starting from `first_landmark`
+  template <typename NeighborGenerator>
+  LandmarkIndex(const NeighborGenerator& graph, uint64_t num_vertices, size_t landmark_count,
+                uint64_t first_landmark, bool symmetric = false)
+      : symmetric_(symmetric) {
+    std::vector<Cost> closest(num_vertices, kUnreachable);
+    uint64_t landmark = first_landmark;
+    for (size_t i = 0; i < landmark_count && num_vertices > 0; ++i) {
+      landmarks_.push_back(landmark);
+      distances_.push_back(ShortestPaths(graph, num_vertices, landmark));
+
+      const std::vector<Cost>& from_landmark = distances_.back();
+      for (uint64_t v = 0; v < num_vertices; ++v) {
+        closest[v] = std::min(closest[v], from_landmark[v]);
+      }
+      // Next landmark: the reachable vertex farthest from all chosen ones
+      uint64_t farthest = landmark;
+      for (uint64_t v = 0; v < num_vertices; ++v) {
+        if (closest[v] != kUnreachable && closest[v] > closest[farthest]) {
+          farthest = v;
+        }
+      }
+      if (farthest == landmark) break;
+      landmark = farthest;
+    }
+  }
+
+  // Lower bound on the distance from `vertex` to `target`; never negative
+  Cost LowerBound(uint64_t vertex, uint64_t target) const {
+    Cost bound = 0;
+    for (const std::vector<Cost>& from_landmark : distances_) {
+      Cost to_target = from_landmark[target];
+      Cost to_vertex = from_landmark[vertex];
+      if (to_target == kUnreachable || to_vertex == kUnreachable) continue;
+      if (to_target > to_vertex) {
+        bound = std::max(bound, to_target - to_vertex);
+      } else if (symmetric_) {
+        bound = std::max(bound, to_vertex - to_target);
+      }
+    }
+    return bound;
+  }
+
+  const std::vector<uint64_t>& Landmarks() const {
+    return landmarks_;
+  }
+
+ private:
+  bool symmetric_;
+  std::vector<uint64_t> landmarks_;
+  std::vector<std::vector<Cost>> distances_;
+
+  template <typename NeighborGenerator>
+  static std::vector<Cost> ShortestPaths(const NeighborGenerator& graph, uint64_t num_vertices, uint64_t source) {
+    std::vector<Cost> distance(num_vertices, kUnreachable);
+    using Entry = std::pair<Cost, uint64_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> pq;
+    distance[source] = 0;
+    pq.emplace(0, source);
+
+    while (!pq.empty()) {
+      auto [cost, vertex] = pq.top();
+      pq.pop();
+      if (cost > distance[vertex]) continue;
+
+      graph.ForEachNeighbor(vertex, [&](auto next, auto weight) {
+        Cost candidate = cost + static_cast<Cost>(weight);
+        if (candidate < distance[next]) {
+          distance[next] = candidate;
+          pq.emplace(candidate, next);
+        }
+      });
+    }
+    return distance;
+  }
+};
+
+#endif  // ALT_LANDMARKS_H_
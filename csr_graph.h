@@ -0,0 +1,204 @@
+#ifndef CSR_GRAPH_H_
+#define CSR_GRAPH_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Marker weight type for graphs whose edges carry no weight
+struct Unweighted {};
+
+// Read-only view of a contiguous run of array elements
+template <typename T>
+class ArraySlice {
+ public:
+  ArraySlice(const T* begin, const T* end) : begin_(begin), end_(end) {}
+
+  const T* begin() const {
+    return begin_;
+  }
+
+  const T* end() const {
+    return end_;
+  }
+
+  size_t size() const {
+    return end_ - begin_;
+  }
+
+  bool empty() const {
+    return begin_ == end_;
+  }
+
+  const T& operator[](size_t i) const {
+    return begin_[i];
+  }
+
+ private:
+  const T* begin_;
+  const T* end_;
+};
+
+// Compressed sparse row graph. The out-edges of v occupy positions
+// offsets[v] .. offsets[v + 1] - 1 of the targets array and, for weighted
+// graphs, of the parallel weights array, so the whole graph lives in two or
+// three allocations instead of one per vertex. An optional reverse CSR
+// stores the in-edges (their sources only) the same way.
+//
+// The graph is also a neighbor generator, with GetNumVertices() and
+// ForEachNeighbor(v, visit) calling visit(next, weight), so it plugs straight
+// into alt_landmarks.h and the generic searches. Unweighted edges are
+// reported with weight 1.
+template <typename Vertex, typename Weight = Unweighted>
+class CsrGraph {
+ public:
+  static constexpr bool kWeighted = !std::is_same_v<Weight, Unweighted>;
+
+  // Build options, combined with |
+  static constexpr unsigned kDirected = 0;
+  static constexpr unsigned kSymmetrize = 1;  // store every edge in both directions
+  static constexpr unsigned kReverse = 2;     // also build the reverse CSR
+
+  // Collects a batch of edges and lays them out with a two-pass counting
+  // sort: the first pass counts out-degrees, a prefix sum turns them into
+  // offsets, and the second pass scatters every edge into its slot. The
+  // scatter is stable, so each vertex lists its edges in insertion order,
+  // exactly as push_back onto adjacency lists would.
+  class Builder {
+   public:
+    explicit Builder(size_t vertex_count) : vertex_count_(vertex_count) {}
+
+    void Reserve(size_t edge_count) {
+      sources_.reserve(edge_count);
+      targets_.reserve(edge_count);
+      if constexpr (kWeighted) weights_.reserve(edge_count);
+    }
+
+    void AddEdge(Vertex from, Vertex to, Weight weight = Weight()) {
+      sources_.push_back(from);
+      targets_.push_back(to);
+      if constexpr (kWeighted) weights_.push_back(weight);
+    }
+
+    size_t EdgeCount() const {
+      return sources_.size();
+    }
+
+    CsrGraph Build(unsigned options = kDirected) const {
+      bool symmetrize = options & kSymmetrize;
+      CsrGraph graph;
+      graph.offsets_.assign(vertex_count_ + 1, 0);
+      for (size_t i = 0; i < sources_.size(); ++i) {
+        ++graph.offsets_[sources_[i] + 1];
+        if (symmetrize) ++graph.offsets_[targets_[i] + 1];
+      }
+      for (size_t v = 0; v < vertex_count_; ++v) {
+        graph.offsets_[v + 1] += graph.offsets_[v];
+      }
+
+      graph.targets_.resize(graph.offsets_[vertex_count_]);
+      if constexpr (kWeighted) graph.weights_.resize(graph.offsets_[vertex_count_]);
+      std::vector<size_t> cursor(graph.offsets_.begin(), graph.offsets_.end() - 1);
+      auto place = [&](size_t i, Vertex from, Vertex to) {
+        size_t slot = cursor[from]++;
+        graph.targets_[slot] = to;
+        if constexpr (kWeighted) graph.weights_[slot] = weights_[i];
+      };
+      for (size_t i = 0; i < sources_.size(); ++i) {
+        place(i, sources_[i], targets_[i]);
+        if (symmetrize) place(i, targets_[i], sources_[i]);
+      }
+
+      if (options & kReverse) graph.BuildReverse();
+      return graph;
+    }
+
+   private:
+    size_t vertex_count_;
+    std::vector<Vertex> sources_;
+    std::vector<Vertex> targets_;
+    std::vector<Weight> weights_;
+  };
+
+  CsrGraph() : offsets_(1, 0) {}
+
+  size_t GetNumVertices() const {
+    return offsets_.size() - 1;
+  }
+
+  size_t EdgeCount() const {
+    return targets_.size();
+  }
+
+  size_t Degree(Vertex v) const {
+    return offsets_[v + 1] - offsets_[v];
+  }
+
+  ArraySlice<Vertex> Neighbors(Vertex v) const {
+    return {targets_.data() + offsets_[v], targets_.data() + offsets_[v + 1]};
+  }
+
+  // Weights of v's out-edges, in the order of Neighbors(v)
+  ArraySlice<Weight> Weights(Vertex v) const {
+    static_assert(kWeighted, "the graph has no edge weights");
+    return {weights_.data() + offsets_[v], weights_.data() + offsets_[v + 1]};
+  }
+
+  template <typename Visit>
+  void ForEachNeighbor(Vertex v, Visit&& visit) const {
+    for (size_t e = offsets_[v]; e < offsets_[v + 1]; ++e) {
+      if constexpr (kWeighted) {
+        visit(targets_[e], weights_[e]);
+      } else {
+        visit(targets_[e], 1);
+      }
+    }
+  }
+
+  bool HasReverse() const {
+    return !reverse_offsets_.empty();
+  }
+
+  size_t InDegree(Vertex v) const {
+    return reverse_offsets_[v + 1] - reverse_offsets_[v];
+  }
+
+  // Sources of v's in-edges; requires the reverse CSR
+  ArraySlice<Vertex> ReverseNeighbors(Vertex v) const {
+    return {reverse_sources_.data() + reverse_offsets_[v], reverse_sources_.data() + reverse_offsets_[v + 1]};
+  }
+
+  // Builds the reverse CSR from the forward one with the same counting sort;
+  // in-edges come out ordered by source vertex
+  void BuildReverse() {
+    size_t vertex_count = GetNumVertices();
+    reverse_offsets_.assign(vertex_count + 1, 0);
+    for (Vertex target : targets_) ++reverse_offsets_[target + 1];
+    for (size_t v = 0; v < vertex_count; ++v) {
+      reverse_offsets_[v + 1] += reverse_offsets_[v];
+    }
+    reverse_sources_.resize(targets_.size());
+    std::vector<size_t> cursor(reverse_offsets_.begin(), reverse_offsets_.end() - 1);
+    for (size_t u = 0; u < vertex_count; ++u) {
+      for (size_t e = offsets_[u]; e < offsets_[u + 1]; ++e) {
+        reverse_sources_[cursor[targets_[e]]++] = static_cast<Vertex>(u);
+      }
+    }
+  }
+
+  // Bytes held by the graph's arrays
+  size_t MemoryBytes() const {
+    return (offsets_.capacity() + reverse_offsets_.capacity()) * sizeof(size_t) +
+           (targets_.capacity() + reverse_sources_.capacity()) * sizeof(Vertex) +
+           weights_.capacity() * sizeof(Weight);
+  }
+
+ private:
+  std::vector<size_t> offsets_;
+  std::vector<Vertex> targets_;
+  std::vector<Weight> weights_;
+  std::vector<size_t> reverse_offsets_;
+  std::vector<Vertex> reverse_sources_;
+};
+
+#endif  // CSR_GRAPH_H_
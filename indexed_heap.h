@@ -0,0 +1,112 @@
+#ifndef INDEXED_HEAP_H_
+#define INDEXED_HEAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Indexed d-ary min-heap over ids 0 .. capacity - 1 with real decrease-key.
+// A position array maps every id to its slot, so each id is in the heap at
+// most once: the heap never holds more than `capacity` entries and a search
+// never pops a stale one. Wider arities make the tree shallower, trading
+// cheaper decrease-keys for more comparisons per pop.
+//
+// Push/Pop/Empty follow the queue interface of monotone_queue.h, with
+// Push acting as insert-or-decrease, so the heap plugs into the same
+// searches.
+template <typename Key, size_t Arity = 4>
+class IndexedDaryHeap {
+  static_assert(Arity >= 2, "a heap needs at least two children per node");
+
+ public:
+  explicit IndexedDaryHeap(size_t capacity) : position_(capacity, kAbsent) {}
+
+  bool Empty() const {
+    return heap_.empty();
+  }
+
+  size_t Size() const {
+    return heap_.size();
+  }
+
+  bool Contains(size_t id) const {
+    return position_[id] != kAbsent;
+  }
+
+  // Inserts `id`, or lowers its key if it is already queued with a larger
+  // one; a larger key for a queued id is ignored
+  void Push(Key key, size_t id) {
+    if (!Contains(id)) {
+      position_[id] = heap_.size();
+      heap_.emplace_back(key, id);
+      SiftUp(heap_.size() - 1);
+    } else if (key < heap_[position_[id]].first) {
+      DecreaseKey(id, key);
+    }
+  }
+
+  void DecreaseKey(size_t id, Key key) {
+    size_t slot = position_[id];
+    heap_[slot].first = key;
+    SiftUp(slot);
+  }
+
+  std::pair<Key, size_t> Pop() {
+    std::pair<Key, size_t> top = heap_.front();
+    position_[top.second] = kAbsent;
+    if (heap_.size() > 1) {
+      heap_.front() = heap_.back();
+      position_[heap_.front().second] = 0;
+      heap_.pop_back();
+      SiftDown(0);
+    } else {
+      heap_.pop_back();
+    }
+    return top;
+  }
+
+ private:
+  static constexpr size_t kAbsent = std::numeric_limits<size_t>::max();
+
+  std::vector<std::pair<Key, size_t>> heap_;
+  std::vector<size_t> position_;
+
+  void Place(size_t slot, const std::pair<Key, size_t>& entry) {
+    heap_[slot] = entry;
+    position_[entry.second] = slot;
+  }
+
+  void SiftUp(size_t slot) {
+    std::pair<Key, size_t> entry = heap_[slot];
+    while (slot > 0) {
+      size_t parent = (slot - 1) / Arity;
+      if (!(entry.first < heap_[parent].first)) break;
+      Place(slot, heap_[parent]);
+      slot = parent;
+    }
+    Place(slot, entry);
+  }
+
+  void SiftDown(size_t slot) {
+    std::pair<Key, size_t> entry = heap_[slot];
+    size_t size = heap_.size();
+    while (true) {
+      size_t first_child = slot * Arity + 1;
+      if (first_child >= size) break;
+      size_t last_child = first_child + Arity < size ? first_child + Arity : size;
+
+      size_t best = first_child;
+      for (size_t child = first_child + 1; child < last_child; ++child) {
+        if (heap_[child].first < heap_[best].first) best = child;
+      }
+      if (!(heap_[best].first < entry.first)) break;
+      Place(slot, heap_[best]);
+      slot = best;
+    }
+    Place(slot, entry);
+  }
+};
+
+#endif  // INDEXED_HEAP_H_
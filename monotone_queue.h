@@ -0,0 +1,156 @@
+#ifndef MONOTONE_QUEUE_H_
+#define MONOTONE_QUEUE_H_
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Priority queues for Dijkstra-style searches over non-negative integer
+// weights. All of them share one interface:
+//
+//   void Push(uint64_t key, const Value& value);
+//   std::pair<uint64_t, Value> Pop();   // entry with the smallest key
+//   bool Empty() const;
+//
+// RadixHeap and WeightClassQueue are monotone: a pushed key must not be
+// smaller than the last popped key, which always holds when the search only
+// pushes settled distance plus a non-negative weight.
+
+// Plain binary heap over std::priority_queue, for comparison
+template <typename Value>
+class BinaryHeapQueue {
+ public:
+  void Push(uint64_t key, const Value& value) {
+    heap_.emplace(key, value);
+  }
+
+  std::pair<uint64_t, Value> Pop() {
+    std::pair<uint64_t, Value> top = heap_.top();
+    heap_.pop();
+    return top;
+  }
+
+  bool Empty() const {
+    return heap_.empty();
+  }
+
+ private:
+  using Entry = std::pair<uint64_t, Value>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap_;
+};
+
+// Radix heap: entries live in the bucket of the highest bit in which their
+// key differs from the last popped key. A pop only scans and redistributes
+// the lowest non-empty bucket, so each entry moves at most 64 times in
+// total, and operations are amortized O(log C) for key range C.
+template <typename Value>
+class RadixHeap {
+ public:
+  void Push(uint64_t key, const Value& value) {
+    assert(key >= last_);
+    buckets_[BucketIndex(key)].emplace_back(key, value);
+    ++size_;
+  }
+
+  std::pair<uint64_t, Value> Pop() {
+    if (buckets_[0].empty()) {
+      size_t index = 1;
+      while (buckets_[index].empty()) ++index;
+
+      auto& bucket = buckets_[index];
+      last_ = std::min_element(bucket.begin(), bucket.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+              })->first;
+      for (const auto& entry : bucket) {
+        buckets_[BucketIndex(entry.first)].push_back(entry);
+      }
+      bucket.clear();
+    }
+
+    std::pair<uint64_t, Value> top = buckets_[0].back();
+    buckets_[0].pop_back();
+    --size_;
+    return top;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  std::array<std::vector<std::pair<uint64_t, Value>>, 65> buckets_;
+  uint64_t last_ = 0;
+  size_t size_ = 0;
+
+  size_t BucketIndex(uint64_t key) const {
+    return key == last_ ? 0 : 64 - __builtin_clzll(key ^ last_);
+  }
+};
+
+// Queue for searches whose edges carry only a few distinct weights. Keys
+// pushed with the same weight arrive in nondecreasing order, so one FIFO per
+// weight is already sorted and a pop only compares the FIFO fronts. The
+// weight of a push is recovered as key minus the last popped key, so pushes
+// must come from expanding the most recently popped entry (or be the initial
+// zero-key push).
+template <typename Value>
+class WeightClassQueue {
+ public:
+  explicit WeightClassQueue(std::vector<uint64_t> weights) : weights_(std::move(weights)) {
+    weights_.push_back(0);
+    std::sort(weights_.begin(), weights_.end());
+    weights_.erase(std::unique(weights_.begin(), weights_.end()), weights_.end());
+    queues_.resize(weights_.size());
+  }
+
+  void Push(uint64_t key, const Value& value) {
+    uint64_t weight = key - last_;
+    size_t weight_class = 0;
+    while (weight_class < weights_.size() && weights_[weight_class] != weight) ++weight_class;
+    assert(key >= last_ && weight_class < weights_.size());
+    queues_[weight_class].entries.emplace_back(key, value);
+    ++size_;
+  }
+
+  std::pair<uint64_t, Value> Pop() {
+    Fifo* best = nullptr;
+    for (Fifo& queue : queues_) {
+      if (queue.head < queue.entries.size() &&
+          (!best || queue.entries[queue.head].first < best->entries[best->head].first)) {
+        best = &queue;
+      }
+    }
+
+    std::pair<uint64_t, Value> top = best->entries[best->head++];
+    // Reclaim the consumed prefix once it dominates the buffer
+    if (best->head > 4096 && best->head * 2 > best->entries.size()) {
+      best->entries.erase(best->entries.begin(), best->entries.begin() + best->head);
+      best->head = 0;
+    }
+    last_ = top.first;
+    --size_;
+    return top;
+  }
+
+  bool Empty() const {
+    return size_ == 0;
+  }
+
+ private:
+  struct Fifo {
+    std::vector<std::pair<uint64_t, Value>> entries;
+    size_t head = 0;
+  };
+
+  std::vector<uint64_t> weights_;
+  std::vector<Fifo> queues_;
+  uint64_t last_ = 0;
+  size_t size_ = 0;
+};
+
+#endif  // MONOTONE_QUEUE_H_